@@ -1,11 +1,18 @@
+#include "LocalSocket.h" //has to come before windows.h
 #include <direct.h> // _getwcwd
 #include <windows.h>
 #include <sstream>
 
 #include "CommonCode.h"
+#include "DaemonProtocol.h"
 
 #include <map>
+#include <set>
+#include <fstream>
 #include <algorithm>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 enum class OutputLocationStatus
 {
@@ -14,14 +21,62 @@ enum class OutputLocationStatus
 	INPUT,
 };
 
+//Kept by the daemon for all of its connections, jobs take the mutex so they run one at a time on the pool
+struct DaemonState
+{
+	explicit DaemonState(const commonCode::ConversionSettings& daemonSettings)
+		: settings{ daemonSettings }
+		, workerPool{ daemonSettings.threadCount }
+	{
+	}
+
+	const commonCode::ConversionSettings settings;
+	commonCode::WorkerPool workerPool;
+	commonCode::BlockList blocks{};
+	commonCode::MaterialRegistry materials{};
+	std::mutex mutex{};
+};
+
 bool IsValidFileArg(const wchar_t* arg, const wchar_t* extension);
+bool IsValidCountArg(const wchar_t* arg, int& count);
+bool AddInputFiles(std::wstring inputArg, std::vector<std::wstring>& inputFilenames, bool& isBatch);
+bool ReadListFile(const std::wstring& listFilename, std::vector<std::wstring>& inputFilenames, bool& isBatch);
+std::wstring GetOutputFilename(const std::wstring& inputFilename, std::wstring outputFilename, const OutputLocationStatus locationStatus, const std::wstring& outputExtension);
+int WatchInput(const std::wstring& inputFilename, const std::wstring& outputFilename, const commonCode::ConversionSettings& settings);
+std::wstring BuildReport(const commonCode::BlockList& blocks, const commonCode::MaterialRegistry& materials, const commonCode::ReportStatus reportStatus);
+std::wstring BuildStatsReport(const commonCode::ConversionStats& stats);
+std::wstring GetFullPath(const std::wstring& filename);
+int RunDaemon(const std::wstring& socketPath, const commonCode::ConversionSettings& settings);
+void ServeDaemonClient(const std::unique_ptr<commonCode::LocalSocket> pClient, const std::shared_ptr<DaemonState> pState);
+int SubmitJobs(const std::wstring& socketPath, const std::vector<commonCode::DaemonJob>& jobs);
+void StartTrace(const std::wstring& traceFilename);
+bool StopTrace(const std::wstring& traceFilename);
+void RunDaemonJob(const commonCode::DaemonJob& job, const commonCode::ConversionSettings& settings, commonCode::WorkerPool& workerPool,
+	commonCode::BlockList& blocks, commonCode::MaterialRegistry& materials, commonCode::DaemonResult& result);
 
 void PrintUsageMsg();
 void PrintArgsMsg();
 void PrintErrorMsg(const std::wstring& customError = L"");
 
+//The tests compile this file without its entry point to run the daemon and its clients in one process
+#if !defined(COMMANDLINETOOL_NO_MAIN)
 int wmain(int argc, wchar_t* argv[], wchar_t* envp[])
 {
+	//--watch and --stats don't have a value, they are taken out so the others still come in pairs
+	const std::wstring watchArg{ L"--watch" };
+	const std::wstring statsArg{ L"--stats" };
+	std::vector<wchar_t*> args{};
+	bool isWatching{ false };
+	bool hasStats{ false };
+	for (int i{ 0 }; i < argc; ++i)
+	{
+		if (i > 0 && watchArg.compare(argv[i]) == 0) isWatching = true;
+		else if (i > 0 && statsArg.compare(argv[i]) == 0) hasStats = true;
+		else args.push_back(argv[i]);
+	}
+	argc = static_cast<int>(args.size());
+	argv = args.data();
+
 	if (argc <= 2)
 	{
 		const std::wstring helpArg{ L"help" };
@@ -56,46 +111,138 @@ int wmain(int argc, wchar_t* argv[], wchar_t* envp[])
 		const std::wstring outputArg{ L"-o" };
 		const std::wstring locationArg{ L"-l" };
 		const std::wstring reportArg{ L"-r" };
+		const std::wstring meshArg{ L"-m" };
+		const std::wstring verticesArg{ L"-v" };
+		const std::wstring threadsArg{ L"--threads" };
+		const std::wstring readerArg{ L"--reader" };
+		const std::wstring simdArg{ L"--simd" };
+		const std::wstring instancingArg{ L"--instancing" };
+		const std::wstring listArg{ L"--list" };
+		const std::wstring formatArg{ L"--format" };
+		const std::wstring daemonArg{ L"--daemon" };
+		const std::wstring connectArg{ L"--connect" };
+		const std::wstring traceArg{ L"--trace" };
 
-		std::wstring inputFilename{ L"" };
+		std::vector<std::wstring> inputFilenames{};
 		std::wstring outputFilename{ L"" };
+		std::wstring outputExtension{ L"" };
+		bool isBatch{ false };
+		std::wstring daemonSocketPath{ L"" };
+		std::wstring connectSocketPath{ L"" };
+		std::wstring traceFilename{ L"" };
 		
 		OutputLocationStatus locationStatus{ OutputLocationStatus::UNDEFINED };
 		commonCode::ReportStatus reportStatus{ commonCode::ReportStatus::UNDEFINED };
+		commonCode::ConversionSettings settings{};
+		bool hasMeshMode{ false };
+		bool hasVertexMode{ false };
+		bool hasThreadCount{ false };
+		bool hasInputMode{ false };
+		bool hasSimdLevel{ false };
+		bool hasInstanceMode{ false };
 
 		for (int i{ 1 }; i < argc; i += 2)
 		{
 			if (inputArg.compare(argv[i]) == 0) //Check input args
 			{
-				if (inputFilename.compare(L"") == 0)
+				if (AddInputFiles(argv[i + 1], inputFilenames, isBatch) == false)
+				{
+					PrintErrorMsg(L"Input has to be .json, a directory or a pattern like *.json and filename must contain at least 1 character!");
+					return -1;
+				}
+			}
+			else if (listArg.compare(argv[i]) == 0) //Check list args
+			{
+				if (ReadListFile(argv[i + 1], inputFilenames, isBatch) == false)
+				{
+					PrintErrorMsg(L"Couldn't read list file or it names an invalid input!");
+					return -1;
+				}
+			}
+			else if (formatArg.compare(argv[i]) == 0) //Check format args
+			{
+				if (outputExtension.compare(L"") == 0)
+				{
+					//Check argument value
+					const std::wstring formatValues[]{ L"obj", L"glb", L"ply", L"stl" };
+
+					for (const std::wstring& formatValue : formatValues)
+					{
+						if (formatValue.compare(argv[i + 1]) == 0) outputExtension = L"." + formatValue;
+					}
+
+					if (outputExtension.compare(L"") == 0) //Handle other values
+					{
+						PrintErrorMsg(L"Unknown format value!");
+						return -1;
+					}
+				}
+				else
+				{
+					PrintErrorMsg(L"Multiple formats were given!");
+					return -1;
+				}
+			}
+			else if (daemonArg.compare(argv[i]) == 0) //Check daemon args
+			{
+				if (daemonSocketPath.compare(L"") == 0)
+				{
+					daemonSocketPath = argv[i + 1];
+				}
+				else
+				{
+					PrintErrorMsg(L"Multiple daemon sockets were given!");
+					return -1;
+				}
+			}
+			else if (connectArg.compare(argv[i]) == 0) //Check connect args
+			{
+				if (connectSocketPath.compare(L"") == 0)
+				{
+					connectSocketPath = argv[i + 1];
+				}
+				else
+				{
+					PrintErrorMsg(L"Multiple daemon sockets to connect to were given!");
+					return -1;
+				}
+			}
+			else if (traceArg.compare(argv[i]) == 0) //Check trace args
+			{
+#if defined(COMMONCODE_TRACE)
+				if (traceFilename.compare(L"") == 0)
 				{
 					if (IsValidFileArg(argv[i + 1], L".json"))
 					{
-						inputFilename = argv[i + 1];
+						traceFilename = argv[i + 1];
 					}
 					else
 					{
-						PrintErrorMsg(L"Input has to be .json and filename must contain at least 1 character!");
+						PrintErrorMsg(L"Trace has to be .json and filename must contain at least 1 character!");
 						return -1;
 					}
 				}
 				else
 				{
-					PrintErrorMsg(L"Multiple inputs were given!");
+					PrintErrorMsg(L"Multiple traces were given!");
 					return -1;
 				}
+#else
+				PrintErrorMsg(L"This build can't record traces, configure it with -DMINECRAFTTOOL_TRACE=ON!");
+				return -1;
+#endif
 			}
 			else if (outputArg.compare(argv[i]) == 0) //Check output args
 			{
 				if (outputFilename.compare(L"") == 0)
 				{
-					if (IsValidFileArg(argv[i + 1], L".obj"))
+					if (IsValidFileArg(argv[i + 1], L".obj") || IsValidFileArg(argv[i + 1], L".glb") || IsValidFileArg(argv[i + 1], L".ply") || IsValidFileArg(argv[i + 1], L".stl"))
 					{
 						outputFilename = argv[i + 1];
 					}
 					else
 					{
-						PrintErrorMsg(L"Output has to be .obj and filename must contain at least 1 character!");
+						PrintErrorMsg(L"Output has to be .obj, .glb, .ply or .stl and filename must contain at least 1 character!");
 						return -1;
 					}
 				}
@@ -140,6 +287,7 @@ int wmain(int argc, wchar_t* argv[], wchar_t* envp[])
 					//Check argument value
 					const std::wstring blocksValue{ L"blocks" };
 					const std::wstring layersValue{ L"layers" };
+					const std::wstring jsonValue{ L"json" };
 
 					if (blocksValue.compare(argv[i + 1]) == 0) //Handle blocks value
 					{
@@ -149,6 +297,10 @@ int wmain(int argc, wchar_t* argv[], wchar_t* envp[])
 					{
 						reportStatus = commonCode::ReportStatus::LAYERS;
 					}
+					else if (jsonValue.compare(argv[i + 1]) == 0) //Handle json value
+					{
+						reportStatus = commonCode::ReportStatus::JSON;
+					}
 					else //Handle other values
 					{
 						PrintErrorMsg(L"Unknown report value!");
@@ -161,6 +313,187 @@ int wmain(int argc, wchar_t* argv[], wchar_t* envp[])
 					return -1;
 				}
 			}
+			else if (meshArg.compare(argv[i]) == 0) //Check mesh args
+			{
+				if (hasMeshMode == false)
+				{
+					//Check argument value
+					const std::wstring blocksValue{ L"blocks" };
+					const std::wstring greedyValue{ L"greedy" };
+
+					if (blocksValue.compare(argv[i + 1]) == 0) //Handle blocks value
+					{
+						settings.meshMode = commonCode::MeshMode::BLOCKS;
+					}
+					else if (greedyValue.compare(argv[i + 1]) == 0) //Handle greedy value
+					{
+						settings.meshMode = commonCode::MeshMode::GREEDY;
+					}
+					else //Handle other values
+					{
+						PrintErrorMsg(L"Unknown mesh value!");
+						return -1;
+					}
+
+					hasMeshMode = true;
+				}
+				else
+				{
+					PrintErrorMsg(L"Multiple meshes were given!");
+					return -1;
+				}
+			}
+			else if (verticesArg.compare(argv[i]) == 0) //Check vertices args
+			{
+				if (hasVertexMode == false)
+				{
+					//Check argument value
+					const std::wstring separateValue{ L"separate" };
+					const std::wstring weldedValue{ L"welded" };
+
+					if (separateValue.compare(argv[i + 1]) == 0) //Handle separate value
+					{
+						settings.weldVertices = false;
+					}
+					else if (weldedValue.compare(argv[i + 1]) == 0) //Handle welded value
+					{
+						settings.weldVertices = true;
+					}
+					else //Handle other values
+					{
+						PrintErrorMsg(L"Unknown vertices value!");
+						return -1;
+					}
+
+					hasVertexMode = true;
+				}
+				else
+				{
+					PrintErrorMsg(L"Multiple vertices were given!");
+					return -1;
+				}
+			}
+			else if (threadsArg.compare(argv[i]) == 0) //Check threads args
+			{
+				if (hasThreadCount == false)
+				{
+					if (IsValidCountArg(argv[i + 1], settings.threadCount))
+					{
+						hasThreadCount = true;
+					}
+					else
+					{
+						PrintErrorMsg(L"Thread count has to be a number between 1 and 1024!");
+						return -1;
+					}
+				}
+				else
+				{
+					PrintErrorMsg(L"Multiple thread counts were given!");
+					return -1;
+				}
+			}
+			else if (readerArg.compare(argv[i]) == 0) //Check reader args
+			{
+				if (hasInputMode == false)
+				{
+					//Check argument value
+					const std::wstring mappedValue{ L"mapped" };
+					const std::wstring streamValue{ L"stream" };
+
+					if (mappedValue.compare(argv[i + 1]) == 0) //Handle mapped value
+					{
+						settings.inputMode = commonCode::InputMode::MAPPED;
+					}
+					else if (streamValue.compare(argv[i + 1]) == 0) //Handle stream value
+					{
+						settings.inputMode = commonCode::InputMode::STREAM;
+					}
+					else //Handle other values
+					{
+						PrintErrorMsg(L"Unknown reader value!");
+						return -1;
+					}
+
+					hasInputMode = true;
+				}
+				else
+				{
+					PrintErrorMsg(L"Multiple readers were given!");
+					return -1;
+				}
+			}
+			else if (simdArg.compare(argv[i]) == 0) //Check simd args
+			{
+				if (hasSimdLevel == false)
+				{
+					//Check argument value
+					const commonCode::SimdLevel simdLevels[]{
+						commonCode::SimdLevel::SCALAR,
+						commonCode::SimdLevel::SSE2,
+						commonCode::SimdLevel::SSE42,
+						commonCode::SimdLevel::AVX2,
+					};
+
+					bool isKnownLevel{ false };
+					for (const commonCode::SimdLevel simdLevel : simdLevels)
+					{
+						if (_wcsicmp(commonCode::ToString(simdLevel), argv[i + 1]) == 0)
+						{
+							settings.simdLevel = simdLevel;
+							isKnownLevel = true;
+						}
+					}
+
+					if (isKnownLevel == false) //Handle other values
+					{
+						PrintErrorMsg(L"Unknown simd value!");
+						return -1;
+					}
+					else if (settings.simdLevel > commonCode::GetSimdLevel())
+					{
+						PrintErrorMsg(L"This simd value is not supported by the CPU!");
+						return -1;
+					}
+
+					hasSimdLevel = true;
+				}
+				else
+				{
+					PrintErrorMsg(L"Multiple simd values were given!");
+					return -1;
+				}
+			}
+			else if (instancingArg.compare(argv[i]) == 0) //Check instancing args
+			{
+				if (hasInstanceMode == false)
+				{
+					//Check argument value
+					const std::wstring autoValue{ L"auto" };
+					const std::wstring offValue{ L"off" };
+
+					if (autoValue.compare(argv[i + 1]) == 0) //Handle auto value
+					{
+						settings.instanceMode = commonCode::InstanceMode::AUTO;
+					}
+					else if (offValue.compare(argv[i + 1]) == 0) //Handle off value
+					{
+						settings.instanceMode = commonCode::InstanceMode::OFF;
+					}
+					else //Handle other values
+					{
+						PrintErrorMsg(L"Unknown instancing value!");
+						return -1;
+					}
+
+					hasInstanceMode = true;
+				}
+				else
+				{
+					PrintErrorMsg(L"Multiple instancing values were given!");
+					return -1;
+				}
+			}
 			else
 			{
 				std::wstringstream errorMsg;
@@ -173,129 +506,190 @@ int wmain(int argc, wchar_t* argv[], wchar_t* envp[])
 			}
 		}
 
-		//Check file names
-		if (inputFilename.compare(L"") != 0)
+		//Run as daemon
+		if (daemonSocketPath.compare(L"") != 0)
 		{
-			//Correct slashes into backslashes
-			std::replace(inputFilename.begin(), inputFilename.end(), '/', '\\');
-
-			if (outputFilename.compare(L"") == 0)
-			{
-				//Set default output
-				outputFilename = inputFilename;
-
-				const std::wstring jsonExtension{ L".json" };
-				const size_t extensionIdx{ outputFilename.rfind(jsonExtension.c_str()) };
-				outputFilename.replace(extensionIdx, jsonExtension.length(), L".obj");
-			}
-			else
+			if (inputFilenames.empty() == false || isBatch || isWatching || hasStats || connectSocketPath.compare(L"") != 0 || traceFilename.compare(L"") != 0)
 			{
-				//Correct slashes into backslashes
-				std::replace(outputFilename.begin(), outputFilename.end(), '/', '\\');
+				PrintErrorMsg(L"The daemon gets its jobs from clients, inputs, --watch, --stats, --connect and --trace can't be given!");
+				return -1;
 			}
 
-			//Set output location
-			switch (locationStatus)
-			{
-			case OutputLocationStatus::CMD:
+			return RunDaemon(daemonSocketPath, settings);
+		}
+
+		//Check file names
+		if (isBatch && inputFilenames.empty())
+		{
+			PrintErrorMsg(L"No input files were found!");
+			return -1;
+		}
+		else if (isBatch)
+		{
+			if (isWatching)
 			{
-				const size_t lastSlashIdx{ outputFilename.rfind(L"\\") };
-				if (lastSlashIdx != std::wstring::npos)
-					outputFilename.replace(0, lastSlashIdx + 1, L"");
-				break;
+				PrintErrorMsg(L"Only a single input file can be watched!");
+				return -1;
 			}
-			case OutputLocationStatus::INPUT:
+			else if (connectSocketPath.compare(L"") != 0 && traceFilename.compare(L"") != 0)
 			{
-				const size_t lastInputSlashIdx{ inputFilename.rfind(L"\\") };
-				const std::wstring inputLocationStr{ inputFilename.substr(
-					0,
-					(lastInputSlashIdx != std::wstring::npos) ? lastInputSlashIdx + 1 : 0
-				) };
-
-				const size_t lastOutputSlashIdx{ outputFilename.rfind(L"\\") };
-				outputFilename.replace(
-					0,
-					(lastOutputSlashIdx != std::wstring::npos) ? lastOutputSlashIdx + 1 : 0,
-					inputLocationStr
-				);
-
-				break;
+				PrintErrorMsg(L"Conversions of a daemon can't be traced!");
+				return -1;
 			}
-
-			case OutputLocationStatus::UNDEFINED:
-			default:
-				break;
+			else if (outputFilename.compare(L"") != 0)
+			{
+				PrintErrorMsg(L"Output can't be given for multiple inputs, use --format instead!");
+				return -1;
 			}
-
-			//Handle file conversion
-			std::vector<commonCode::Block> blocks{};
-			std::wstring message{ L"" };
-			if (commonCode::ConvertJsonToObj(inputFilename, outputFilename, blocks, message) == -1)
+			else if (reportStatus != commonCode::ReportStatus::UNDEFINED)
 			{
-				wprintf_s(message.c_str());
+				PrintErrorMsg(L"Reports can't be given for multiple inputs!");
 				return -1;
 			}
-			else
+			else if (hasStats)
 			{
-				wprintf_s(message.c_str());
+				PrintErrorMsg(L"Stats can't be given for multiple inputs!");
+				return -1;
 			}
 
-			//Handle reporting
-			switch (reportStatus)
-			{
-			case commonCode::ReportStatus::BLOCKS: //Report blocks
+			//Every input needs an output of its own
+			std::vector<commonCode::BatchJob> jobs{};
+			std::set<std::wstring> jobOutputFilenames{};
+			for (const std::wstring& inputFilename : inputFilenames)
 			{
-				wprintf_s(L"\nReport:\n");
-
-				int blockIdx{ 0 };
-				for (const commonCode::Block& b : blocks)
+				const std::wstring jobOutputFilename{ GetOutputFilename(inputFilename, L"", locationStatus, outputExtension) };
+				if (jobOutputFilenames.insert(jobOutputFilename).second == false)
 				{
-					wprintf_s(
-						L"id: %d\tlayer: %s\topaque: %s\tposition: %.4f, %.4f, %.4f\n",
-						blockIdx, b.layerName.c_str(), b.isOpaque ? L"true" : L"false", b.pos.x, b.pos.y, b.pos.z
-					);
-					++blockIdx;
+					PrintErrorMsg(L"Multiple inputs would be written to the same output (" + jobOutputFilename + L")!");
+					return -1;
 				}
 
-				wprintf_s(L"\n");
+				jobs.push_back(commonCode::BatchJob{ inputFilename, jobOutputFilename });
+			}
 
-				break;
+			//Let a daemon convert the files
+			if (connectSocketPath.compare(L"") != 0)
+			{
+				std::vector<commonCode::DaemonJob> daemonJobs{};
+				for (const commonCode::BatchJob& job : jobs)
+				{
+					daemonJobs.push_back(commonCode::DaemonJob{ GetFullPath(job.inputFilename), GetFullPath(job.outputFilename), L"", L"" });
+				}
+
+				return SubmitJobs(connectSocketPath, daemonJobs);
 			}
 
-			case commonCode::ReportStatus::LAYERS: //Report layers
+			//Handle file conversions
+			std::vector<std::wstring> messages{};
+			commonCode::BatchStats stats{};
+			StartTrace(traceFilename);
+			commonCode::ConvertBatch(jobs, settings, messages, stats);
+			if (StopTrace(traceFilename) == false) return -1;
+
+			//Messages are printed in job order once every file is done, warnings get the filename like the result does
+			for (size_t jobIdx{ 0 }; jobIdx < jobs.size(); ++jobIdx)
 			{
-				std::map<const std::wstring, int> layers{};
-				for (const commonCode::Block& b : blocks)
+				const std::wstring& message{ messages[jobIdx] };
+				size_t lineStart{ 0 };
+				while (lineStart < message.size())
 				{
-					const std::wstring layername{ b.layerName };
+					const size_t lineEnd{ message.find(L'\n', lineStart) };
+					const std::wstring line{ message.substr(lineStart, (lineEnd == std::wstring::npos) ? std::wstring::npos : lineEnd - lineStart) };
+					wprintf_s(L"%s: %s\n", jobs[jobIdx].inputFilename.c_str(), line.c_str());
+					if (lineEnd == std::wstring::npos) break;
+					lineStart = lineEnd + 1;
+				}
+			}
 
-					if (layers.find(layername) != layers.end())
-					{
-						++layers[layername];
-					}
-					else
-					{
-						layers[layername] = 1;
-					}
+			wprintf_s(
+				L"Converted %d of %d files in %.3f s (%.1f files/s, %.0f blocks/s, %.1f MB/s)\n",
+				static_cast<int>(stats.fileCount), static_cast<int>(jobs.size()), stats.time,
+				stats.GetFileThroughput(), stats.GetBlockThroughput(), stats.GetInputThroughput()
+			);
+
+			return (stats.failedCount == 0) ? 0 : -1;
+		}
+		else if (inputFilenames.empty() == false)
+		{
+			const std::wstring& inputFilename{ inputFilenames.front() };
+			outputFilename = GetOutputFilename(inputFilename, outputFilename, locationStatus, outputExtension);
+
+			if (isWatching)
+			{
+				if (reportStatus != commonCode::ReportStatus::UNDEFINED || hasStats || traceFilename.compare(L"") != 0)
+				{
+					PrintErrorMsg(L"Reports, stats and traces can't be given while watching!");
+					return -1;
+				}
+				else if (connectSocketPath.compare(L"") != 0)
+				{
+					PrintErrorMsg(L"A daemon can't watch input files!");
+					return -1;
 				}
 
-				wprintf_s(L"\nReport:\n");
+				return WatchInput(inputFilename, outputFilename, settings);
+			}
 
-				int layerIdx{ 0 };
-				for (const auto& layerIt : layers)
+			//Let a daemon convert the file, it runs elsewhere so the paths are made absolute
+			if (connectSocketPath.compare(L"") != 0)
+			{
+				if (hasStats)
+				{
+					PrintErrorMsg(L"Stats of a daemon can only be given as -r json!");
+					return -1;
+				}
+				else if (traceFilename.compare(L"") != 0)
 				{
-					wprintf_s(L"id: %d\t layer name: %s\tnr of blocks: %d\n", layerIdx, layerIt.first.c_str(), layerIt.second);
-					++layerIdx;
+					PrintErrorMsg(L"Conversions of a daemon can't be traced!");
+					return -1;
 				}
-				
-				wprintf_s(L"\n");
 
-				break;
+				const std::wstring reportValue{
+					(reportStatus == commonCode::ReportStatus::BLOCKS) ? L"blocks" : (reportStatus == commonCode::ReportStatus::LAYERS) ? L"layers"
+					: (reportStatus == commonCode::ReportStatus::JSON) ? L"json" : L""
+				};
+
+				return SubmitJobs(connectSocketPath, { commonCode::DaemonJob{ GetFullPath(inputFilename), GetFullPath(outputFilename), L"", reportValue } });
+			}
+
+			//Handle file conversion
+			commonCode::BlockList blocks{};
+			commonCode::MaterialRegistry materials{};
+			std::wstring message{ L"" };
+			commonCode::ConversionStats stats{};
+			StartTrace(traceFilename);
+			const int result{ commonCode::ConvertJsonToMesh(inputFilename, outputFilename, blocks, materials, message, settings, stats) };
+			if (StopTrace(traceFilename) == false) return -1;
+
+			if (result == -1)
+			{
+				wprintf_s(message.c_str());
+				return -1;
+			}
+			else
+			{
+				wprintf_s(message.c_str());
 			}
 
-			case commonCode::ReportStatus::UNDEFINED: //Report nothing
-			default:
-				break;
+			//Handle stats
+			if (hasStats)
+			{
+				wprintf_s(
+					L"Parsed %.2f MB in %.3f s (%.1f MB/s, %s)\n",
+					stats.inputSize / 1000000.0, stats.GetPhaseTime(commonCode::ConversionPhase::PARSE).wallTime, stats.GetParseThroughput(),
+					(settings.inputMode == commonCode::InputMode::MAPPED) ? commonCode::ToString(settings.simdLevel) : L"stream"
+				);
+				wprintf_s(L"%s", BuildStatsReport(stats).c_str());
+			}
+
+			//Handle reporting
+			if (reportStatus == commonCode::ReportStatus::JSON)
+			{
+				wprintf_s(L"%s\n", commonCode::FromUtf8(commonCode::FormatStatsJson(stats, inputFilename, outputFilename)).c_str());
+			}
+			else
+			{
+				wprintf_s(L"%s", BuildReport(blocks, materials, reportStatus).c_str());
 			}
 
 			return 0;
@@ -310,6 +704,7 @@ int wmain(int argc, wchar_t* argv[], wchar_t* envp[])
 	PrintErrorMsg();
 	return -1;
 }
+#endif
 
 bool IsValidFileArg(const wchar_t* arg, const wchar_t* extension)
 {
@@ -325,6 +720,475 @@ bool IsValidFileArg(const wchar_t* arg, const wchar_t* extension)
 	return false;
 }
 
+bool IsValidCountArg(const wchar_t* arg, int& count)
+{
+	wchar_t* pEnd{ nullptr };
+	const long value{ wcstol(arg, &pEnd, 10) };
+
+	if (pEnd != arg && *pEnd == L'\0' && value >= 1 && value <= 1024)
+	{
+		count = static_cast<int>(value);
+		return true;
+	}
+
+	return false;
+}
+
+//Output of an input file, the default output replaces .json with the format extension
+std::wstring GetOutputFilename(const std::wstring& inputFilename, std::wstring outputFilename, const OutputLocationStatus locationStatus, const std::wstring& outputExtension)
+{
+	if (outputFilename.compare(L"") == 0)
+	{
+		//Set default output
+		outputFilename = inputFilename;
+
+		const std::wstring jsonExtension{ L".json" };
+		const size_t extensionIdx{ outputFilename.rfind(jsonExtension.c_str()) };
+		outputFilename.replace(extensionIdx, jsonExtension.length(), (outputExtension.compare(L"") != 0) ? outputExtension : L".obj");
+	}
+	else
+	{
+		//Correct slashes into backslashes
+		std::replace(outputFilename.begin(), outputFilename.end(), '/', '\\');
+	}
+
+	//Set output location
+	switch (locationStatus)
+	{
+	case OutputLocationStatus::CMD:
+	{
+		const size_t lastSlashIdx{ outputFilename.rfind(L"\\") };
+		if (lastSlashIdx != std::wstring::npos)
+			outputFilename.replace(0, lastSlashIdx + 1, L"");
+		break;
+	}
+	case OutputLocationStatus::INPUT:
+	{
+		const size_t lastInputSlashIdx{ inputFilename.rfind(L"\\") };
+		const std::wstring inputLocationStr{ inputFilename.substr(
+			0,
+			(lastInputSlashIdx != std::wstring::npos) ? lastInputSlashIdx + 1 : 0
+		) };
+
+		const size_t lastOutputSlashIdx{ outputFilename.rfind(L"\\") };
+		outputFilename.replace(
+			0,
+			(lastOutputSlashIdx != std::wstring::npos) ? lastOutputSlashIdx + 1 : 0,
+			inputLocationStr
+		);
+
+		break;
+	}
+
+	case OutputLocationStatus::UNDEFINED:
+	default:
+		break;
+	}
+
+	return outputFilename;
+}
+
+//Converts the input file, then converts it again every time it is written until the program is stopped
+//.obj outputs keep the scene in memory and only mesh the chunks that changed, other formats are converted in full
+int WatchInput(const std::wstring& inputFilename, const std::wstring& outputFilename, const commonCode::ConversionSettings& settings)
+{
+	commonCode::FileWatcher watcher{};
+	if (watcher.Open(inputFilename) == false)
+	{
+		PrintErrorMsg(L"Failed to watch input file!");
+		return -1;
+	}
+
+	const bool isObj{ commonCode::GetOutputFormat(outputFilename) == commonCode::OutputFormat::OBJ };
+	commonCode::WatchedScene scene{};
+	commonCode::WorkerPool workerPool{ settings.threadCount };
+
+	wprintf_s(L"Watching %s, press Ctrl+C to stop\n", inputFilename.c_str());
+
+	do
+	{
+		std::wstring message{ L"" };
+		commonCode::ConversionStats stats{};
+
+		if (isObj)
+		{
+			commonCode::WatchStats watchStats{};
+			const int result{ commonCode::UpdateWatchedObj(inputFilename, outputFilename, scene, message, settings, stats, watchStats, workerPool) };
+
+			wprintf_s(message.c_str());
+			if (result == 0)
+			{
+				wprintf_s(
+					L"Meshed %d of %d chunks in %.1f ms\n",
+					static_cast<int>(watchStats.meshedChunkCount), static_cast<int>(watchStats.chunkCount), watchStats.updateTime * 1000.0
+				);
+			}
+		}
+		else
+		{
+			commonCode::ConvertJsonToMesh(inputFilename, outputFilename, scene.blocks, scene.fileMaterials, message, settings, stats, workerPool);
+			wprintf_s(message.c_str());
+		}
+	} while (watcher.WaitForChange());
+
+	PrintErrorMsg(L"Input directory can't be watched anymore!");
+	return -1;
+}
+
+//Report text of a converted scene, empty when no report was asked for
+std::wstring BuildReport(const commonCode::BlockList& blocks, const commonCode::MaterialRegistry& materials, const commonCode::ReportStatus reportStatus)
+{
+	std::wstring report{ L"" };
+	wchar_t line[1024];
+
+	switch (reportStatus)
+	{
+	case commonCode::ReportStatus::BLOCKS: //Report blocks
+	{
+		report += L"\nReport:\n";
+
+		for (size_t blockIdx{ 0 }; blockIdx < blocks.GetCount(); ++blockIdx)
+		{
+			const commonCode::Block b{ blocks.GetBlock(blockIdx) };
+			swprintf_s(
+				line, L"id: %d\tlayer: %s\topaque: %s\tposition: %.4f, %.4f, %.4f\n",
+				static_cast<int>(blockIdx), materials.GetName(b.materialId).c_str(), b.isOpaque ? L"true" : L"false", b.pos.x, b.pos.y, b.pos.z
+			);
+			report += line;
+		}
+
+		report += L"\n";
+
+		break;
+	}
+
+	case commonCode::ReportStatus::LAYERS: //Report layers
+	{
+		std::vector<int> blockCounts(materials.GetCount());
+		for (const uint16_t materialId : blocks.GetMaterialIds())
+		{
+			++blockCounts[materialId];
+		}
+
+		//Sort layers by name
+		std::map<const std::wstring, int> layers{};
+		for (uint16_t materialId{ 0 }; materialId < materials.GetCount(); ++materialId)
+		{
+			if (blockCounts[materialId] > 0) layers[materials.GetName(materialId)] = blockCounts[materialId];
+		}
+
+		report += L"\nReport:\n";
+
+		int layerIdx{ 0 };
+		for (const auto& layerIt : layers)
+		{
+			swprintf_s(line, L"id: %d\t layer name: %s\tnr of blocks: %d\n", layerIdx, layerIt.first.c_str(), layerIt.second);
+			report += line;
+			++layerIdx;
+		}
+
+		report += L"\n";
+
+		break;
+	}
+
+	case commonCode::ReportStatus::JSON: //Stats are reported by the caller, they aren't kept with the blocks
+	case commonCode::ReportStatus::UNDEFINED: //Report nothing
+	default:
+		break;
+	}
+
+	return report;
+}
+
+//Table of the time spent in every phase of a conversion and what it produced
+std::wstring BuildStatsReport(const commonCode::ConversionStats& stats)
+{
+	std::wstring report{ L"\nStats:\n" };
+	wchar_t line[256];
+
+	report += L"phase\t\twall ms\t\tcpu ms\n";
+	double wallTime{ 0.0 };
+	double cpuTime{ 0.0 };
+	for (size_t phaseIdx{ 0 }; phaseIdx < commonCode::CONVERSION_PHASE_COUNT; ++phaseIdx)
+	{
+		const commonCode::PhaseTime& phaseTime{ stats.phaseTimes[phaseIdx] };
+		swprintf_s(
+			line, L"%-12s\t%10.3f\t%10.3f\n",
+			commonCode::ToString(static_cast<commonCode::ConversionPhase>(phaseIdx)), phaseTime.wallTime * 1000.0, phaseTime.cpuTime * 1000.0
+		);
+		report += line;
+
+		wallTime += phaseTime.wallTime;
+		cpuTime += phaseTime.cpuTime;
+	}
+	swprintf_s(line, L"%-12s\t%10.3f\t%10.3f\n", L"total", wallTime * 1000.0, cpuTime * 1000.0);
+	report += line;
+
+	swprintf_s(
+		line, L"blocks: %llu\tlayers: %llu\nfaces emitted: %llu\tfaces culled: %llu\n",
+		static_cast<unsigned long long>(stats.blockCount), static_cast<unsigned long long>(stats.layerCount),
+		static_cast<unsigned long long>(stats.emittedFaceCount), static_cast<unsigned long long>(stats.culledFaceCount)
+	);
+	report += line;
+
+	swprintf_s(
+		line, L"bytes read: %llu\tbytes written: %llu\npeak memory: %.1f MB\n\n",
+		static_cast<unsigned long long>(stats.inputSize), static_cast<unsigned long long>(stats.outputSize), stats.peakMemoryUsage / 1000000.0
+	);
+	report += line;
+
+	return report;
+}
+
+std::wstring GetFullPath(const std::wstring& filename)
+{
+	wchar_t* pFullPath{ _wfullpath(nullptr, filename.c_str(), 0) };
+	if (pFullPath == nullptr) return filename;
+
+	const std::wstring fullPath{ pFullPath };
+	free(pFullPath);
+	return fullPath;
+}
+
+//Converts the jobs of clients until the program is stopped, every connection is served on a thread of its own
+//so a client that waits between jobs doesn't hold up the others, the jobs themselves still run one after the other
+//The worker pool and the block and material lists are kept between jobs, so their threads and memory are already there
+int RunDaemon(const std::wstring& socketPath, const commonCode::ConversionSettings& settings)
+{
+	commonCode::LocalSocket server{};
+	if (server.Connect(socketPath))
+	{
+		PrintErrorMsg(L"A daemon is already listening on " + socketPath + L"!");
+		return -1;
+	}
+	else if (server.Listen(socketPath) == false)
+	{
+		PrintErrorMsg(L"Failed to listen on " + socketPath + L"!");
+		return -1;
+	}
+
+	//Shared with the connection threads, which can outlive this function
+	const std::shared_ptr<DaemonState> pState{ std::make_shared<DaemonState>(settings) };
+
+	wprintf_s(L"Listening on %s, press Ctrl+C to stop\n", socketPath.c_str());
+
+	std::unique_ptr<commonCode::LocalSocket> pClient{ std::make_unique<commonCode::LocalSocket>() };
+	while (server.Accept(*pClient))
+	{
+		std::thread{ ServeDaemonClient, std::move(pClient), pState }.detach();
+		pClient = std::make_unique<commonCode::LocalSocket>();
+	}
+
+	PrintErrorMsg(L"Failed to accept a connection on " + socketPath + L"!");
+	return -1;
+}
+
+//Answers the jobs of one connection until the client closes it
+void ServeDaemonClient(const std::unique_ptr<commonCode::LocalSocket> pClient, const std::shared_ptr<DaemonState> pState)
+{
+	//A client can send several jobs over one connection
+	std::string line{};
+	while (pClient->ReceiveLine(line))
+	{
+		commonCode::DaemonJob job{};
+		commonCode::DaemonResult result{ -1, 0.0, L"", L"" };
+		{
+			std::lock_guard<std::mutex> lock{ pState->mutex };
+
+			if (commonCode::DecodeDaemonJob(line, job)) RunDaemonJob(job, pState->settings, pState->workerPool, pState->blocks, pState->materials, result);
+			else result.message = L"Invalid job!\n";
+
+			wprintf_s(L"%s: %s", job.inputFilename.c_str(), result.message.c_str());
+		}
+
+		if (pClient->SendLine(commonCode::EncodeDaemonResult(result)) == false) break;
+	}
+}
+
+void RunDaemonJob(const commonCode::DaemonJob& job, const commonCode::ConversionSettings& settings, commonCode::WorkerPool& workerPool,
+	commonCode::BlockList& blocks, commonCode::MaterialRegistry& materials, commonCode::DaemonResult& result)
+{
+	const std::chrono::steady_clock::time_point jobStart{ std::chrono::steady_clock::now() };
+
+	//Check job
+	const std::wstring formatValues[]{ L"", L"obj", L"glb", L"ply", L"stl" };
+	const std::wstring reportValues[]{ L"", L"blocks", L"layers", L"json" };
+	const commonCode::ReportStatus reportStatuses[]{
+		commonCode::ReportStatus::UNDEFINED, commonCode::ReportStatus::BLOCKS, commonCode::ReportStatus::LAYERS, commonCode::ReportStatus::JSON
+	};
+
+	const auto formatIt{ std::find(std::begin(formatValues), std::end(formatValues), job.format) };
+	const auto reportIt{ std::find(std::begin(reportValues), std::end(reportValues), job.report) };
+	const std::wstring outputExtension{ (job.format.compare(L"") != 0) ? L"." + job.format : L"" };
+
+	if (IsValidFileArg(job.inputFilename.c_str(), L".json") == false)
+	{
+		result.message = L"Input has to be .json and filename must contain at least 1 character!\n";
+		return;
+	}
+	else if (formatIt == std::end(formatValues))
+	{
+		result.message = L"Unknown format value!\n";
+		return;
+	}
+	else if (reportIt == std::end(reportValues))
+	{
+		result.message = L"Unknown report value!\n";
+		return;
+	}
+	else if (job.outputFilename.compare(L"") != 0 && outputExtension.compare(L"") != 0 && commonCode::HasExtension(job.outputFilename, outputExtension) == false)
+	{
+		result.message = L"Output doesn't have the extension of the format!\n";
+		return;
+	}
+
+	const std::wstring outputFilename{ GetOutputFilename(job.inputFilename, job.outputFilename, OutputLocationStatus::UNDEFINED, outputExtension) };
+
+	//Handle file conversion
+	commonCode::ConversionStats stats{};
+	result.status = commonCode::ConvertJsonToMesh(job.inputFilename, outputFilename, blocks, materials, result.message, settings, stats, workerPool);
+	const commonCode::ReportStatus reportStatus{ reportStatuses[reportIt - std::begin(reportValues)] };
+	if (result.status == 0 && reportStatus == commonCode::ReportStatus::JSON)
+	{
+		result.report = commonCode::FromUtf8(commonCode::FormatStatsJson(stats, job.inputFilename, outputFilename)) + L"\n";
+	}
+	else if (result.status == 0)
+	{
+		result.report = BuildReport(blocks, materials, reportStatus);
+	}
+
+	result.time = std::chrono::duration<double>(std::chrono::steady_clock::now() - jobStart).count();
+}
+
+//Sends the jobs to a daemon over one connection and prints its results
+int SubmitJobs(const std::wstring& socketPath, const std::vector<commonCode::DaemonJob>& jobs)
+{
+	commonCode::LocalSocket daemonSocket{};
+	if (daemonSocket.Connect(socketPath) == false)
+	{
+		PrintErrorMsg(L"No daemon is listening on " + socketPath + L"!");
+		return -1;
+	}
+
+	int failedCount{ 0 };
+	for (const commonCode::DaemonJob& job : jobs)
+	{
+		std::string line{};
+		commonCode::DaemonResult result{};
+		if (daemonSocket.SendLine(commonCode::EncodeDaemonJob(job)) == false || daemonSocket.ReceiveLine(line) == false || commonCode::DecodeDaemonResult(line, result) == false)
+		{
+			PrintErrorMsg(L"The daemon closed the connection!");
+			return -1;
+		}
+
+		if (jobs.size() > 1) wprintf_s(L"%s: ", job.inputFilename.c_str());
+		wprintf_s(L"%s", result.message.c_str());
+		if (result.status == 0) wprintf_s(L"Converted by the daemon in %.3f s\n", result.time);
+		wprintf_s(L"%s", result.report.c_str());
+
+		if (result.status != 0) ++failedCount;
+	}
+
+	return (failedCount == 0) ? 0 : -1;
+}
+
+//Records the spans of the conversions until StopTrace, does nothing without a trace file
+//--trace is refused while checking the arguments when the spans aren't compiled in
+void StartTrace(const std::wstring& traceFilename)
+{
+#if defined(COMMONCODE_TRACE)
+	if (traceFilename.compare(L"") != 0) commonCode::TraceRecorder::GetInstance().Start();
+#endif
+}
+
+bool StopTrace(const std::wstring& traceFilename)
+{
+#if defined(COMMONCODE_TRACE)
+	if (traceFilename.compare(L"") != 0 && commonCode::TraceRecorder::GetInstance().Stop(traceFilename) == false)
+	{
+		wprintf_s(L"Failed to write trace file!\n");
+		return false;
+	}
+#endif
+	return true;
+}
+
+//Adds a .json file, every .json file of a directory or the .json files matching a pattern
+//Directories and patterns always start a batch, even when they match a single file
+bool AddInputFiles(std::wstring inputArg, std::vector<std::wstring>& inputFilenames, bool& isBatch)
+{
+	//Correct slashes into backslashes
+	std::replace(inputArg.begin(), inputArg.end(), '/', '\\');
+
+	const bool isPattern{ inputArg.find_first_of(L"*?") != std::wstring::npos };
+	if (isPattern == false && IsValidFileArg(inputArg.c_str(), L".json"))
+	{
+		isBatch = isBatch || inputFilenames.empty() == false;
+		inputFilenames.push_back(inputArg);
+		return true;
+	}
+
+	std::wstring pattern{ inputArg };
+	if (isPattern == false)
+	{
+		const DWORD attributes{ GetFileAttributesW(inputArg.c_str()) };
+		if (attributes == INVALID_FILE_ATTRIBUTES || (attributes & FILE_ATTRIBUTE_DIRECTORY) == 0) return false;
+
+		if (pattern.back() != L'\\') pattern += L'\\';
+		pattern += L"*.json";
+	}
+
+	const size_t lastSlashIdx{ pattern.rfind(L"\\") };
+	const std::wstring directory{ pattern.substr(0, (lastSlashIdx != std::wstring::npos) ? lastSlashIdx + 1 : 0) };
+
+	//Sorted, so batches convert in the same order on every run
+	std::vector<std::wstring> foundFilenames{};
+	WIN32_FIND_DATAW findData{};
+	const HANDLE hFind{ FindFirstFileW(pattern.c_str(), &findData) };
+	if (hFind != INVALID_HANDLE_VALUE)
+	{
+		do
+		{
+			if ((findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0 && IsValidFileArg(findData.cFileName, L".json"))
+			{
+				foundFilenames.push_back(directory + findData.cFileName);
+			}
+		} while (FindNextFileW(hFind, &findData));
+
+		FindClose(hFind);
+	}
+
+	std::sort(foundFilenames.begin(), foundFilenames.end());
+	inputFilenames.insert(inputFilenames.end(), foundFilenames.begin(), foundFilenames.end());
+	isBatch = true;
+	return true;
+}
+
+//Adds the inputs of a UTF-8 text file, one file, directory or pattern per line, empty lines are skipped
+//A list file always starts a batch
+bool ReadListFile(const std::wstring& listFilename, std::vector<std::wstring>& inputFilenames, bool& isBatch)
+{
+	std::ifstream is{ listFilename };
+	if (is.is_open() == false) return false;
+
+	std::string line{};
+	while (std::getline(is, line))
+	{
+		if (line.empty() == false && line.back() == '\r') line.pop_back();
+		if (line.empty()) continue;
+
+		const int wideLength{ MultiByteToWideChar(CP_UTF8, 0, line.c_str(), static_cast<int>(line.size()), nullptr, 0) };
+		std::wstring inputArg(static_cast<size_t>(wideLength), L'\0');
+		MultiByteToWideChar(CP_UTF8, 0, line.c_str(), static_cast<int>(line.size()), &inputArg[0], wideLength);
+
+		if (AddInputFiles(inputArg, inputFilenames, isBatch) == false) return false;
+	}
+
+	isBatch = true;
+	return true;
+}
+
 void PrintUsageMsg()
 {
 	wprintf_s(L"Usage:\n");
@@ -337,6 +1201,7 @@ void PrintUsageMsg()
 	wprintf_s(L"\t(required arguments):\n");
 	wprintf_s(L"\t\t-i <inputFile>.json\n");
 	wprintf_s(L"\t\t\tinputFile --> name of input file, can also include path to different directory\n");
+	wprintf_s(L"\t\t\t\tcan be given multiple times, a directory or a pattern like regions\\*.json converts every matching .json file\n");
 
 	wprintf_s(L"\t(optional arguments):\n");
 	wprintf_s(L"\t\tcmdMinecraftTool args\n");
@@ -348,19 +1213,71 @@ void PrintArgsMsg()
 	wprintf_s(L"\t(required arguments):\n");
 	wprintf_s(L"\t\t-i <inputFile>.json\n");
 	wprintf_s(L"\t\t\tinputFile --> name of input file, can also include path to different directory\n");
+	wprintf_s(L"\t\t\t\tcan be given multiple times, a directory or a pattern like regions\\*.json converts every matching .json file\n");
 
 	wprintf_s(L"\t(optional arguments):\n");
-	wprintf_s(L"\t\t-o <outputFile>.obj\n");
+	wprintf_s(L"\t\t-o <outputFile>.<obj|glb|ply|stl>\n");
 	wprintf_s(L"\t\t\toutputFile --> name of output file, can also include path to different directory\n");
+	wprintf_s(L"\t\t\t\tobj --> Wavefront OBJ text\n");
+	wprintf_s(L"\t\t\t\tglb --> binary glTF, materials are read from Resources\\minecraftMats.mtl next to the output file\n");
+	wprintf_s(L"\t\t\t\tply --> binary PLY with normals, texture coordinates and a material index per face\n");
+	wprintf_s(L"\t\t\t\tstl --> binary STL, only the shape\n");
 	wprintf_s(L"\t\t\t\tnot defined --> outputFile == inputFile, also copies path to input file directory\n");
+	wprintf_s(L"\t\t--list <listFile>\n");
+	wprintf_s(L"\t\t\tlistFile --> text file with one input file, directory or pattern per line\n");
+	wprintf_s(L"\t\t\t\tmultiple inputs are converted as a batch, each to its own output file next to its input\n");
+	wprintf_s(L"\t\t\t\t--threads sets how many files are converted at the same time, -o and -r can't be given\n");
+	wprintf_s(L"\t\t--format <obj|glb|ply|stl>\n");
+	wprintf_s(L"\t\t\tformat of output files that aren't named with -o\n");
+	wprintf_s(L"\t\t\t\tnot defined --> obj\n");
 	wprintf_s(L"\t\t-l <cmd|input>\n");
 	wprintf_s(L"\t\t\tcmd --> output file location == current cmd location\n");
 	wprintf_s(L"\t\t\tinput --> output file location == input file location\n");
 	wprintf_s(L"\t\t\t\tnot defined --> output file location is unchanged\n");
-	wprintf_s(L"\t\t-r <blocks|layers>\n");
+	wprintf_s(L"\t\t-r <blocks|layers|json>\n");
 	wprintf_s(L"\t\t\tblocks --> report blocks info\n");
 	wprintf_s(L"\t\t\tlayers --> report layer info\n");
+	wprintf_s(L"\t\t\tjson --> report the conversion stats as a single line of JSON\n");
 	wprintf_s(L"\t\t\t\tnot defined --> no report\n");
+	wprintf_s(L"\t\t--stats\n");
+	wprintf_s(L"\t\t\tprints wall and CPU time of every conversion phase, block, layer and face counts, bytes read and written and peak memory\n");
+	wprintf_s(L"\t\t\t\ta single input file only, can't be given while watching or to a daemon\n");
+	wprintf_s(L"\t\t-m <blocks|greedy>\n");
+	wprintf_s(L"\t\t\tblocks --> every block is written as a cube of its own\n");
+	wprintf_s(L"\t\t\tgreedy --> neighbouring faces with the same material are merged into large quads\n");
+	wprintf_s(L"\t\t\t\tnot defined --> blocks\n");
+	wprintf_s(L"\t\t-v <separate|welded>\n");
+	wprintf_s(L"\t\t\tseparate --> every cube or quad writes its own vertices\n");
+	wprintf_s(L"\t\t\twelded --> shared corners are written once, only for visible faces\n");
+	wprintf_s(L"\t\t\t\tnot defined --> separate\n");
+	wprintf_s(L"\t\t--instancing <auto|off>\n");
+	wprintf_s(L"\t\t\tauto --> layers whose blocks have few neighbours are written to a .glb file as instanced cubes (EXT_mesh_gpu_instancing)\n");
+	wprintf_s(L"\t\t\toff --> every layer is written as faces\n");
+	wprintf_s(L"\t\t\t\tnot defined --> auto\n");
+	wprintf_s(L"\t\t--watch\n");
+	wprintf_s(L"\t\t\tconverts the input file again every time it is saved, until Ctrl+C is pressed\n");
+	wprintf_s(L"\t\t\t\t.obj outputs only mesh the chunks that changed, greedy mode merges faces within a chunk and vertices aren't welded\n");
+	wprintf_s(L"\t\t\t\ta single input file only, -r and --stats can't be given\n");
+	wprintf_s(L"\t\t--daemon <socketFile>\n");
+	wprintf_s(L"\t\t\truns as a daemon that converts the jobs of clients connecting to socketFile, until Ctrl+C is pressed\n");
+	wprintf_s(L"\t\t\t\tthe daemon's -m, -v, --threads, --reader, --simd and --instancing are used for every job, -i can't be given\n");
+	wprintf_s(L"\t\t--connect <socketFile>\n");
+	wprintf_s(L"\t\t\tlets the daemon listening on socketFile convert the inputs instead of this process\n");
+	wprintf_s(L"\t\t\t\t-o, -l, --format and -r are sent along, the other conversion arguments are the daemon's\n");
+	wprintf_s(L"\t\t--trace <traceFile>.json\n");
+	wprintf_s(L"\t\t\ttraceFile --> spans of every phase, chunk and worker thread in the Chrome trace event format, open it in Perfetto\n");
+	wprintf_s(L"\t\t\t\tonly builds configured with -DMINECRAFTTOOL_TRACE=ON record traces, can't be given while watching or to a daemon\n");
+	wprintf_s(L"\t\t--threads <count>\n");
+	wprintf_s(L"\t\t\tcount --> number of threads that parse a mapped input file, cull and merge faces and format the output, between 1 and 1024\n");
+	wprintf_s(L"\t\t\t\ta batch converts count files at the same time instead, each on a single thread\n");
+	wprintf_s(L"\t\t\t\tnot defined --> 1 thread\n");
+	wprintf_s(L"\t\t--reader <mapped|stream>\n");
+	wprintf_s(L"\t\t\tmapped --> input file is memory-mapped and parsed in place\n");
+	wprintf_s(L"\t\t\tstream --> input file is parsed through a file stream\n");
+	wprintf_s(L"\t\t\t\tnot defined --> mapped, stream when the file can't be mapped\n");
+	wprintf_s(L"\t\t--simd <scalar|sse2|sse4.2|avx2>\n");
+	wprintf_s(L"\t\t\tinstruction set used to scan a mapped input file and to cull hidden faces, has to be supported by the CPU\n");
+	wprintf_s(L"\t\t\t\tnot defined --> widest instruction set the CPU supports\n");
 	wprintf_s(L"\n");
 
 	wprintf_s(L"Examples:\n");
@@ -370,6 +1287,19 @@ void PrintArgsMsg()
 	wprintf_s(L"\t\tresulting output: myOutput.obj\n");
 	wprintf_s(L"\tcmdMinecraftTool -i ..\\myInput.json -o myOutput.obj -l input\n");
 	wprintf_s(L"\t\tresulting output: ..\\myOutput.obj\n");
+	wprintf_s(L"\tcmdMinecraftTool -i ..\\myInput.json --threads 8\n");
+	wprintf_s(L"\t\tresulting output: ..\\myInput.obj, parsed, culled and written on 8 threads\n");
+	wprintf_s(L"\tcmdMinecraftTool -i ..\\myInput.json -o myOutput.glb -m greedy\n");
+	wprintf_s(L"\t\tresulting output: myOutput.glb, merged faces as binary glTF\n");
+	wprintf_s(L"\tcmdMinecraftTool -i ..\\regions --format glb --threads 8\n");
+	wprintf_s(L"\t\tresulting output: a .glb file next to every .json file in ..\\regions, 8 files at a time\n");
+	wprintf_s(L"\tcmdMinecraftTool --daemon minecraftTool.sock --threads 8\n");
+	wprintf_s(L"\tcmdMinecraftTool -i ..\\myInput.json --connect minecraftTool.sock\n");
+	wprintf_s(L"\t\tresulting output: ..\\myInput.obj, converted by the daemon on 8 threads\n");
+	wprintf_s(L"\tcmdMinecraftTool -i ..\\myInput.json --watch\n");
+	wprintf_s(L"\t\tresulting output: ..\\myInput.obj, updated whenever ..\\myInput.json is saved\n");
+	wprintf_s(L"\tcmdMinecraftTool -i ..\\myInput.json --stats -r json\n");
+	wprintf_s(L"\t\tresulting output: ..\\myInput.obj, prints where the conversion spent its time as a table and as JSON\n");
 	wprintf_s(L"\n");
 
 	wprintf_s(L"Argument order does not matter!\n");
@@ -0,0 +1,159 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+#include "CubeMesh.h"
+#include "WorkerPool.h"
+#include "ObjWriter.h"
+
+namespace commonCode
+{
+	//Quads per task when a binary mesh is filled
+	constexpr size_t BINARY_MESH_RANGE_SIZE{ 16 * 1024 };
+
+	//Binary PLY with fixed size records, every quad is written as 4 vertices and 1 quad face
+	//Vertex: x y z nx ny nz s t as float, face: uchar 4, 4 uint vertex indices, ushort material
+	constexpr size_t PLY_VERTEX_SIZE{ 8 * sizeof(float) };
+	constexpr size_t PLY_FACE_SIZE{ 1 + 4 * sizeof(uint32_t) + sizeof(uint16_t) };
+
+	//Binary STL: 80 byte header, uint32 triangle count, then per triangle a normal, 3 vertices and a uint16 attribute
+	constexpr size_t STL_HEADER_SIZE{ 80 + sizeof(uint32_t) };
+	constexpr size_t STL_TRIANGLE_SIZE{ 12 * sizeof(float) + sizeof(uint16_t) };
+
+	//The material names are kept as comments, the material property of a face indexes them
+	inline std::string BuildPlyHeader(const size_t quadCount, const std::vector<std::wstring>& layerNames)
+	{
+		std::string header{ "ply\nformat binary_little_endian 1.0\ncomment generated by MinecraftTool\n" };
+		for (size_t materialId{ 0 }; materialId < layerNames.size(); ++materialId)
+		{
+			header += "comment material " + std::to_string(materialId) + " " + ToUtf8(layerNames[materialId]) + "\n";
+		}
+
+		header += "element vertex " + std::to_string(quadCount * 4) + "\n";
+		header += "property float x\nproperty float y\nproperty float z\n";
+		header += "property float nx\nproperty float ny\nproperty float nz\n";
+		header += "property float s\nproperty float t\n";
+		header += "element face " + std::to_string(quadCount) + "\n";
+		header += "property list uchar uint vertex_indices\n";
+		header += "property ushort material\n";
+		header += "end_header\n";
+		return header;
+	}
+
+	inline size_t GetPlyFileSize(const std::string& header, const size_t quadCount)
+	{
+		return header.size() + quadCount * (4 * PLY_VERTEX_SIZE + PLY_FACE_SIZE);
+	}
+
+	//pOutput has to hold GetPlyFileSize bytes, the records are little-endian like every platform this builds for
+	inline void WritePly(char* pOutput, const std::string& header, const std::vector<MeshQuad>& quads, WorkerPool& workerPool)
+	{
+		memcpy(pOutput, header.data(), header.size());
+
+		char* pVertices{ pOutput + header.size() };
+		char* pFaces{ pVertices + quads.size() * 4 * PLY_VERTEX_SIZE };
+
+		const std::vector<QuadCorners> quadCorners{ BuildQuadCorners() };
+		const size_t rangeCount{ (quads.size() + BINARY_MESH_RANGE_SIZE - 1) / BINARY_MESH_RANGE_SIZE };
+
+		workerPool.ParallelFor(rangeCount, 1,
+			[&](const size_t begin, const size_t end, const int)
+			{
+				const size_t quadEnd{ (std::min)(end * BINARY_MESH_RANGE_SIZE, quads.size()) };
+				for (size_t quadIdx{ begin * BINARY_MESH_RANGE_SIZE }; quadIdx < quadEnd; ++quadIdx)
+				{
+					const MeshQuad& quad{ quads[quadIdx] };
+					const CubeFace& cubeFace{ CUBE_FACES[quad.face] };
+					const QuadCorners& corners{ quadCorners[quad.face] };
+					const float* normal{ CUBE_NORMALS[cubeFace.normalIdx - 1] };
+
+					//Vertices, texture coordinates repeat per block like in the .obj output
+					for (int corner{ 0 }; corner < 4; ++corner)
+					{
+						float vertex[8];
+						for (int axis{ 0 }; axis < 3; ++axis)
+						{
+							vertex[axis] = static_cast<float>(quad.pos[axis] + GetCubeVertexOffset(corners.vertexIndices[corner], axis) * quad.size[axis]);
+							vertex[3 + axis] = normal[axis];
+						}
+						vertex[6] = static_cast<float>(GetTexCoordOffset(corners.texCoordIndices[corner], 0) * quad.size[cubeFace.sAxis]);
+						vertex[7] = static_cast<float>(GetTexCoordOffset(corners.texCoordIndices[corner], 1) * quad.size[cubeFace.tAxis]);
+
+						memcpy(pVertices + (quadIdx * 4 + corner) * PLY_VERTEX_SIZE, vertex, PLY_VERTEX_SIZE);
+					}
+
+					//Face
+					char* pFace{ pFaces + quadIdx * PLY_FACE_SIZE };
+
+					*pFace++ = 4;
+					for (const int corner : corners.outline)
+					{
+						const uint32_t index{ static_cast<uint32_t>(quadIdx * 4 + corner) };
+						memcpy(pFace, &index, sizeof(index));
+						pFace += sizeof(index);
+					}
+					memcpy(pFace, &quad.materialId, sizeof(quad.materialId));
+				}
+			}
+		);
+	}
+
+	inline size_t GetStlFileSize(const size_t quadCount)
+	{
+		return STL_HEADER_SIZE + quadCount * 2 * STL_TRIANGLE_SIZE;
+	}
+
+	//pOutput has to hold GetStlFileSize bytes, STL has no materials or texture coordinates so only the shape is written
+	inline void WriteStl(char* pOutput, const std::vector<MeshQuad>& quads, WorkerPool& workerPool)
+	{
+		//The header can't start with "solid", readers would take the file for ASCII STL
+		memset(pOutput, 0, STL_HEADER_SIZE);
+		const char description[]{ "binary STL generated by MinecraftTool" };
+		memcpy(pOutput, description, sizeof(description) - 1);
+
+		const uint32_t triangleCount{ static_cast<uint32_t>(quads.size() * 2) };
+		memcpy(pOutput + 80, &triangleCount, sizeof(triangleCount));
+
+		char* pTriangles{ pOutput + STL_HEADER_SIZE };
+
+		const std::vector<QuadCorners> quadCorners{ BuildQuadCorners() };
+		const size_t rangeCount{ (quads.size() + BINARY_MESH_RANGE_SIZE - 1) / BINARY_MESH_RANGE_SIZE };
+
+		workerPool.ParallelFor(rangeCount, 1,
+			[&](const size_t begin, const size_t end, const int)
+			{
+				const size_t quadEnd{ (std::min)(end * BINARY_MESH_RANGE_SIZE, quads.size()) };
+				for (size_t quadIdx{ begin * BINARY_MESH_RANGE_SIZE }; quadIdx < quadEnd; ++quadIdx)
+				{
+					const MeshQuad& quad{ quads[quadIdx] };
+					const QuadCorners& corners{ quadCorners[quad.face] };
+					const float* normal{ CUBE_NORMALS[CUBE_FACES[quad.face].normalIdx - 1] };
+
+					for (int triangle{ 0 }; triangle < 2; ++triangle)
+					{
+						float record[12];
+						memcpy(record, normal, 3 * sizeof(float));
+
+						for (int i{ 0 }; i < 3; ++i)
+						{
+							const int vertexIdx{ corners.vertexIndices[corners.triangles[triangle * 3 + i]] };
+							for (int axis{ 0 }; axis < 3; ++axis)
+							{
+								record[3 + i * 3 + axis] = static_cast<float>(quad.pos[axis] + GetCubeVertexOffset(vertexIdx, axis) * quad.size[axis]);
+							}
+						}
+
+						char* pTriangle{ pTriangles + (quadIdx * 2 + triangle) * STL_TRIANGLE_SIZE };
+						memcpy(pTriangle, record, sizeof(record));
+
+						const uint16_t attribute{ 0 };
+						memcpy(pTriangle + sizeof(record), &attribute, sizeof(attribute));
+					}
+				}
+			}
+		);
+	}
+}
@@ -0,0 +1,192 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+
+#include "VoxelGrid.h"
+#include "WorkerPool.h"
+#include "CubeMesh.h"
+#include "ObjWriter.h"
+
+namespace commonCode
+{
+	//Keeps the .obj text of every chunk of a scene so a changed scene only re-meshes the chunks whose cells changed
+	//and the chunks bordering them, the other chunks keep their text
+	//Face indices are relative (negative) and the normals and unit texture coordinates are the ones every .obj header has,
+	//so the text of a chunk doesn't depend on where it ends up in the file
+	class ChunkMeshCache
+	{
+	public:
+		//Takes over the grid of the new scene, its faces don't have to be culled
+		//Returns how many chunks were meshed again, simdLevel picks the face culling kernel
+		size_t Update(VoxelGrid&& grid, const bool mergeFaces, WorkerPool& workerPool, const SimdLevel simdLevel = GetSimdLevel())
+		{
+			const int neighbourOffsets[NEIGHBOUR_COUNT][3]{ { 0, 0, 1 }, { 0, 0, -1 }, { 0, 1, 0 }, { 0, -1, 0 }, { 1, 0, 0 }, { -1, 0, 0 } };
+
+			const std::vector<VoxelChunk>& chunks{ grid.GetChunks() };
+			const bool isRebuilt{ m_IsEmpty || mergeFaces != m_MergeFaces };
+
+			std::vector<bool> isDirty(chunks.size(), false);
+			const auto markDirty{ [&grid, &isDirty, &neighbourOffsets](const VoxelChunk& chunk, const bool includeSelf)
+				{
+					if (includeSelf) isDirty[grid.FindChunkIdx(chunk.chunkX, chunk.chunkY, chunk.chunkZ)] = true;
+
+					//Culling looks one cell into the neighbours, so their border faces may have changed too
+					for (const int* offset : neighbourOffsets)
+					{
+						const uint32_t neighbourIdx{ grid.FindChunkIdx(chunk.chunkX + offset[0], chunk.chunkY + offset[1], chunk.chunkZ + offset[2]) };
+						if (neighbourIdx != CoordHashMap::INVALID_INDEX) isDirty[neighbourIdx] = true;
+					}
+				}
+			};
+
+			//New and changed chunks
+			for (const VoxelChunk& chunk : chunks)
+			{
+				const uint32_t oldIdx{ isRebuilt ? CoordHashMap::INVALID_INDEX : m_Grid.FindChunkIdx(chunk.chunkX, chunk.chunkY, chunk.chunkZ) };
+				if (oldIdx == CoordHashMap::INVALID_INDEX || HasSameCells(chunk, m_Grid.GetChunks()[oldIdx]) == false) markDirty(chunk, true);
+			}
+
+			//Removed chunks
+			if (isRebuilt) m_Meshes.clear();
+			for (const VoxelChunk& oldChunk : m_Grid.GetChunks())
+			{
+				if (isRebuilt || grid.FindChunkIdx(oldChunk.chunkX, oldChunk.chunkY, oldChunk.chunkZ) != CoordHashMap::INVALID_INDEX) continue;
+
+				m_Meshes.erase(CoordKey{ oldChunk.chunkX, oldChunk.chunkY, oldChunk.chunkZ });
+				markDirty(oldChunk, false);
+			}
+
+			std::vector<uint32_t> dirtyIndices{};
+			for (size_t i{ 0 }; i < chunks.size(); ++i)
+			{
+				if (isDirty[i]) dirtyIndices.push_back(static_cast<uint32_t>(i));
+			}
+
+			//Only the dirty chunks are culled, the faces of the others aren't needed again
+			grid.CullFaces(workerPool, dirtyIndices, simdLevel);
+
+			std::vector<std::vector<ChunkMesh>> dirtyMeshes(dirtyIndices.size());
+			std::vector<ObjWriter> writers(workerPool.GetThreadCount());
+
+			workerPool.ParallelFor(dirtyIndices.size(), 1,
+				[&chunks, &dirtyIndices, &dirtyMeshes, &writers, mergeFaces](const size_t begin, const size_t end, const int threadIdx)
+				{
+					const std::vector<QuadCorners> quadCorners{ BuildQuadCorners() };
+					std::vector<MeshQuad> quads{};
+
+					for (size_t i{ begin }; i < end; ++i)
+					{
+						COMMONCODE_TRACE_SCOPE("mesh chunk", "chunk", static_cast<int64_t>(dirtyIndices[i]));
+						quads.clear();
+						BuildChunkQuads(chunks[dirtyIndices[i]], mergeFaces, quads);
+
+						//One piece of text per material, the quads are sorted by material
+						for (size_t quadIdx{ 0 }; quadIdx < quads.size();)
+						{
+							ObjWriter& writer{ writers[threadIdx] };
+							writer.Clear();
+
+							const uint16_t materialId{ quads[quadIdx].materialId };
+							for (; quadIdx < quads.size() && quads[quadIdx].materialId == materialId; ++quadIdx)
+							{
+								WriteQuad(writer, quads[quadIdx], quadCorners[quads[quadIdx].face]);
+							}
+
+							dirtyMeshes[i].push_back(ChunkMesh{ materialId, std::string{ writer.GetData(), writer.GetSize() } });
+						}
+					}
+				}
+			);
+
+			for (size_t i{ 0 }; i < dirtyIndices.size(); ++i)
+			{
+				const VoxelChunk& chunk{ chunks[dirtyIndices[i]] };
+				m_Meshes[CoordKey{ chunk.chunkX, chunk.chunkY, chunk.chunkZ }] = std::move(dirtyMeshes[i]);
+			}
+
+			m_Grid = std::move(grid);
+			m_MergeFaces = mergeFaces;
+			m_IsEmpty = false;
+			return dirtyIndices.size();
+		}
+
+		//Writes the faces of every chunk grouped by material, the header with normals and unit texture coordinates has to be written already
+		void Write(ObjWriter& writer, const std::vector<std::wstring>& layerNames) const
+		{
+			std::vector<std::vector<const std::string*>> layerTexts(layerNames.size());
+			for (const VoxelChunk& chunk : m_Grid.GetChunks())
+			{
+				const auto meshIt{ m_Meshes.find(CoordKey{ chunk.chunkX, chunk.chunkY, chunk.chunkZ }) };
+				if (meshIt == m_Meshes.end()) continue;
+
+				for (const ChunkMesh& mesh : meshIt->second) layerTexts[mesh.materialId].push_back(&mesh.text);
+			}
+
+			for (size_t materialId{ 0 }; materialId < layerTexts.size(); ++materialId)
+			{
+				if (layerTexts[materialId].empty()) continue;
+
+				writer.WriteMaterial(layerNames[materialId]);
+				for (const std::string* pText : layerTexts[materialId]) writer.Write(pText->data(), pText->size());
+			}
+		}
+
+		size_t GetChunkCount() const { return m_Grid.GetChunks().size(); }
+
+	private:
+		struct ChunkMesh
+		{
+			uint16_t materialId;
+			std::string text;
+		};
+
+		VoxelGrid m_Grid{};
+		std::unordered_map<CoordKey, std::vector<ChunkMesh>, CoordKeyHash> m_Meshes{};
+		bool m_MergeFaces{ false };
+		bool m_IsEmpty{ true };
+
+		//4 vertices and 2 faces, merged quads add 4 texture coordinates scaled by their size
+		static void WriteQuad(ObjWriter& writer, const MeshQuad& quad, const QuadCorners& corners)
+		{
+			const CubeFace& cubeFace{ CUBE_FACES[quad.face] };
+			const int sSize{ quad.size[cubeFace.sAxis] };
+			const int tSize{ quad.size[cubeFace.tAxis] };
+
+			for (int corner{ 0 }; corner < 4; ++corner)
+			{
+				const int vertexIdx{ corners.vertexIndices[corner] };
+				writer.WriteVertex(
+					quad.pos[0] + GetCubeVertexOffset(vertexIdx, 0) * quad.size[0],
+					quad.pos[1] + GetCubeVertexOffset(vertexIdx, 1) * quad.size[1],
+					quad.pos[2] + GetCubeVertexOffset(vertexIdx, 2) * quad.size[2]
+				);
+			}
+
+			//Unit quads use texture coordinates 1 to 4 of the header, the others the 4 written here
+			const bool isUnit{ sSize == 1 && tSize == 1 };
+			if (isUnit == false)
+			{
+				writer.WriteTexCoord(0, 0);
+				writer.WriteTexCoord(sSize, 0);
+				writer.WriteTexCoord(0, tSize);
+				writer.WriteTexCoord(sSize, tSize);
+			}
+			const int texCoordOffset{ isUnit ? 0 : -5 };
+
+			for (int triangle{ 0 }; triangle < 2; ++triangle)
+			{
+				const int* pCorners{ &corners.triangles[triangle * 3] };
+				const int* pTexCoords{ &cubeFace.texCoordIndices[triangle * 3] };
+
+				writer.WriteFace(
+					pCorners[0] - 4, texCoordOffset + pTexCoords[0], cubeFace.normalIdx,
+					pCorners[1] - 4, texCoordOffset + pTexCoords[1], cubeFace.normalIdx,
+					pCorners[2] - 4, texCoordOffset + pTexCoords[2], cubeFace.normalIdx
+				);
+			}
+		}
+	};
+}
@@ -3,13 +3,33 @@
 #include <string>
 #include <iostream>
 #include <fstream>
+#include <cstdint>
+#include <cmath>
+#include <climits>
+#include <map>
+#include <algorithm>
+#include <chrono>
 
 #include "rapidjson/rapidjson.h"
 #include "rapidjson/document.h"
+#include "rapidjson/reader.h"
 #include "rapidjson/stream.h"
 #include "rapidjson/istreamwrapper.h"
 #include "rapidjson/filereadstream.h"
 
+#include "VoxelGrid.h"
+#include "WorkerPool.h"
+#include "CubeMesh.h"
+#include "MaterialRegistry.h"
+#include "MappedFile.h"
+#include "JsonScan.h"
+#include "ObjWriter.h"
+#include "GlbWriter.h"
+#include "BinaryMeshWriter.h"
+#include "ChunkMeshCache.h"
+#include "ConversionStats.h"
+#include "FileWatcher.h"
+
 namespace commonCode
 {
 	inline bool AreEqual(const float a, const float b, const float epsilon = FLT_EPSILON)
@@ -46,19 +66,86 @@ namespace commonCode
 
 	struct Block
 	{
-		const std::wstring layerName;
+		uint16_t materialId; //id of the layer name in the MaterialRegistry of the scene
 		bool isOpaque;
 		Vector3f pos;
 	};
 
-	enum class OpaqueNeighbourPos
+	//Blocks of a scene stored as separate arrays, block i is made of element i of every array
+	//Takes 14 bytes and 1 bit per block, positions are whole block coordinates so they compare exactly
+	class BlockList
 	{
-		FRONT,
-		BACK,
-		LEFT,
-		RIGHT,
-		TOP,
-		BOTTOM,
+	public:
+		void Reserve(const size_t count)
+		{
+			m_Xs.reserve(count);
+			m_Ys.reserve(count);
+			m_Zs.reserve(count);
+			m_MaterialIds.reserve(count);
+			m_OpaqueBits.reserve((count + 63) / 64);
+		}
+
+		void Add(const int x, const int y, const int z, const uint16_t materialId, const bool isOpaque)
+		{
+			const size_t blockIdx{ m_Xs.size() };
+			if (blockIdx % 64 == 0) m_OpaqueBits.push_back(0);
+			if (isOpaque) m_OpaqueBits.back() |= uint64_t{ 1 } << (blockIdx % 64);
+
+			m_Xs.push_back(x);
+			m_Ys.push_back(y);
+			m_Zs.push_back(z);
+			m_MaterialIds.push_back(materialId);
+		}
+
+		//Removes every block from count onwards
+		void Truncate(const size_t count)
+		{
+			if (count >= GetCount()) return;
+
+			m_Xs.resize(count);
+			m_Ys.resize(count);
+			m_Zs.resize(count);
+			m_MaterialIds.resize(count);
+			m_OpaqueBits.resize((count + 63) / 64);
+			if (count % 64 != 0) m_OpaqueBits.back() &= (uint64_t{ 1 } << (count % 64)) - 1;
+		}
+
+		void Clear()
+		{
+			Truncate(0);
+		}
+
+		size_t GetCount() const { return m_Xs.size(); }
+		bool IsEmpty() const { return m_Xs.empty(); }
+
+		int GetX(const size_t blockIdx) const { return m_Xs[blockIdx]; }
+		int GetY(const size_t blockIdx) const { return m_Ys[blockIdx]; }
+		int GetZ(const size_t blockIdx) const { return m_Zs[blockIdx]; }
+		uint16_t GetMaterialId(const size_t blockIdx) const { return m_MaterialIds[blockIdx]; }
+		bool IsOpaque(const size_t blockIdx) const { return ((m_OpaqueBits[blockIdx / 64] >> (blockIdx % 64)) & 1) != 0; }
+
+		bool HasSamePosition(const size_t blockIdx, const size_t otherBlockIdx) const
+		{
+			return m_Xs[blockIdx] == m_Xs[otherBlockIdx] && m_Ys[blockIdx] == m_Ys[otherBlockIdx] && m_Zs[blockIdx] == m_Zs[otherBlockIdx];
+		}
+
+		//Copy of a single block, for reports
+		Block GetBlock(const size_t blockIdx) const
+		{
+			return Block{ GetMaterialId(blockIdx), IsOpaque(blockIdx), Vector3f{ GetX(blockIdx), GetY(blockIdx), GetZ(blockIdx) } };
+		}
+
+		const std::vector<int32_t>& GetXs() const { return m_Xs; }
+		const std::vector<int32_t>& GetYs() const { return m_Ys; }
+		const std::vector<int32_t>& GetZs() const { return m_Zs; }
+		const std::vector<uint16_t>& GetMaterialIds() const { return m_MaterialIds; }
+
+	private:
+		std::vector<int32_t> m_Xs{};
+		std::vector<int32_t> m_Ys{};
+		std::vector<int32_t> m_Zs{};
+		std::vector<uint16_t> m_MaterialIds{};
+		std::vector<uint64_t> m_OpaqueBits{}; //bit i % 64 of element i / 64 is set for opaque blocks
 	};
 
 	enum class ReportStatus
@@ -66,251 +153,1858 @@ namespace commonCode
 		UNDEFINED = -1,
 		BLOCKS = 1,
 		LAYERS = 2,
+		JSON = 3, //conversion stats as JSON
+	};
+
+	enum class MeshMode
+	{
+		BLOCKS, //every block is a cube of its own
+		GREEDY, //coplanar faces of the same material are merged into large quads
+	};
+
+	enum class InstanceMode
+	{
+		AUTO, //sparse layers of a .glb file are written as instanced cubes
+		OFF, //every layer is written as merged faces
+	};
+
+	enum class InputMode
+	{
+		MAPPED, //parse straight from a memory-mapped view of the file
+		STREAM, //parse through a file stream
+	};
+
+	struct ConversionSettings
+	{
+		int threadCount{ 1 };
+		MeshMode meshMode{ MeshMode::BLOCKS };
+		bool weldVertices{ false }; //write every distinct corner once and only when a visible face uses it
+		InstanceMode instanceMode{ InstanceMode::AUTO };
+		InputMode inputMode{ InputMode::MAPPED };
+		SimdLevel simdLevel{ GetSimdLevel() }; //widest instruction set used to scan mapped input
+	};
+
+	inline int ToBlockCoord(const float value)
+	{
+		return static_cast<int>(std::lround(value));
+	}
+
+	//Hash set of opaque block positions
+	//Built once so every neighbour check is a constant time probe
+	//Conversions cull with the voxel grid, this and CheckOpaqueNeighbours are the reference the face kernels are tested against
+	class OpaqueBlockIndex
+	{
+	public:
+		explicit OpaqueBlockIndex(const BlockList& blocks)
+			: m_Positions{ blocks.GetCount() }
+		{
+			for (size_t i{ 0 }; i < blocks.GetCount(); ++i)
+			{
+				//ignore transparant blocks
+				if (blocks.IsOpaque(i) == false) continue;
+
+				m_Positions.Insert(CoordKey{ blocks.GetX(i), blocks.GetY(i), blocks.GetZ(i) }, 0);
+			}
+		}
+
+		bool Contains(const int x, const int y, const int z) const
+		{
+			return m_Positions.Find(CoordKey{ x, y, z }) != CoordHashMap::INVALID_INDEX;
+		}
+
+	private:
+		CoordHashMap m_Positions;
 	};
 
-	inline std::vector<OpaqueNeighbourPos> CheckOpaqueNeighbours(const Block& blockToCheck, const std::vector<Block>& blocks)
+	inline std::vector<OpaqueNeighbourPos> CheckOpaqueNeighbours(const Block& blockToCheck, const OpaqueBlockIndex& opaqueBlocks)
 	{
 		std::vector<OpaqueNeighbourPos> opaqueNeighbours{};
 
 		//Check if the block we are checking is transparant
 		if (blockToCheck.isOpaque == false) return opaqueNeighbours;
 
-		const Vector3f posToCheck{ blockToCheck.pos };
-		for (const Block& block : blocks)
-		{
-			//ignore transparant blocks
-			if (block.isOpaque == false) continue;
+		const int x{ ToBlockCoord(blockToCheck.pos.x) };
+		const int y{ ToBlockCoord(blockToCheck.pos.y) };
+		const int z{ ToBlockCoord(blockToCheck.pos.z) };
+
+		//Probe the 6 neighbouring positions
+		if (opaqueBlocks.Contains(x, y, z - 1)) opaqueNeighbours.push_back(OpaqueNeighbourPos::LEFT);
+		if (opaqueBlocks.Contains(x, y, z + 1)) opaqueNeighbours.push_back(OpaqueNeighbourPos::RIGHT);
+		if (opaqueBlocks.Contains(x, y - 1, z)) opaqueNeighbours.push_back(OpaqueNeighbourPos::BOTTOM);
+		if (opaqueBlocks.Contains(x, y + 1, z)) opaqueNeighbours.push_back(OpaqueNeighbourPos::TOP);
+		if (opaqueBlocks.Contains(x - 1, y, z)) opaqueNeighbours.push_back(OpaqueNeighbourPos::FRONT);
+		if (opaqueBlocks.Contains(x + 1, y, z)) opaqueNeighbours.push_back(OpaqueNeighbourPos::BACK);
+
+		return opaqueNeighbours;
+	}
 
-			//Check if the block is neighbouring
-			const Vector3f blockPos{ block.pos };
+	//Block positions are whole numbers, so the vertices are written without float formatting
+	template<typename Writer>
+	inline void WriteVertices(Writer& writer, const int x, const int y, const int z)
+	{
+		//Vertices
+		writer.WriteVertex(x, y, z);
+		writer.WriteVertex(x, y, z + 1);
+		writer.WriteVertex(x, y + 1, z);
+		writer.WriteVertex(x, y + 1, z + 1);
+		writer.WriteVertex(x + 1, y, z);
+		writer.WriteVertex(x + 1, y, z + 1);
+		writer.WriteVertex(x + 1, y + 1, z);
+		writer.WriteVertex(x + 1, y + 1, z + 1);
+	}
+
+	//Vertices of the blocks in [begin, end) that are not fully hidden
+	//Traced as one span per range, a span per block would cost more than the block
+	template<typename Writer>
+	inline void WriteBlockVertices(Writer& writer, const BlockList& blocks, const std::vector<uint8_t>& blockFaces, const size_t begin, const size_t end)
+	{
+		COMMONCODE_TRACE_SCOPE("WriteVertices", "begin", static_cast<int64_t>(begin), "end", static_cast<int64_t>(end));
 
-			if (blockPos.IsEqual(Vector3f{ posToCheck.x, posToCheck.y, posToCheck.z - 1.f })) opaqueNeighbours.push_back(OpaqueNeighbourPos::LEFT);
-			else if (blockPos.IsEqual(Vector3f{ posToCheck.x, posToCheck.y, posToCheck.z + 1.f })) opaqueNeighbours.push_back(OpaqueNeighbourPos::RIGHT);
-			else if (blockPos.IsEqual(Vector3f{ posToCheck.x, posToCheck.y - 1.f, posToCheck.z })) opaqueNeighbours.push_back(OpaqueNeighbourPos::BOTTOM);
-			else if (blockPos.IsEqual(Vector3f{ posToCheck.x, posToCheck.y + 1.f, posToCheck.z })) opaqueNeighbours.push_back(OpaqueNeighbourPos::TOP);
-			else if (blockPos.IsEqual(Vector3f{ posToCheck.x - 1.f, posToCheck.y, posToCheck.z })) opaqueNeighbours.push_back(OpaqueNeighbourPos::FRONT);
-			else if (blockPos.IsEqual(Vector3f{ posToCheck.x + 1.f, posToCheck.y, posToCheck.z })) opaqueNeighbours.push_back(OpaqueNeighbourPos::BACK);
+		for (size_t i{ begin }; i < end; ++i)
+		{
+			if (blockFaces[i] != 0) WriteVertices(writer, blocks.GetX(i), blocks.GetY(i), blocks.GetZ(i));
 		}
+	}
 
-		return opaqueNeighbours;
+	//Builds the chunked voxel grid of the scene and culls the hidden faces of every chunk, simdLevel picks the culling kernel
+	inline void BuildVoxelGrid(const BlockList& blocks, VoxelGrid& grid, WorkerPool& workerPool, ConversionStats& stats, const SimdLevel simdLevel = GetSimdLevel())
+	{
+		{
+			PhaseTimer timer{ stats, ConversionPhase::BLOCK_BUILD };
+			for (size_t i{ 0 }; i < blocks.GetCount(); ++i)
+			{
+				grid.SetBlock(blocks.GetX(i), blocks.GetY(i), blocks.GetZ(i), blocks.IsOpaque(i), blocks.GetMaterialId(i));
+			}
+		}
+
+		PhaseTimer timer{ stats, ConversionPhase::CULL };
+		grid.CullFaces(workerPool, simdLevel);
 	}
 
-	inline void WriteVertices(FILE* pOFile, const Vector3f& blockPos)
+	inline void BuildVoxelGrid(const BlockList& blocks, VoxelGrid& grid, WorkerPool& workerPool)
 	{
-		float xPos{ blockPos.x };
-		float yPos{ blockPos.y };
-		float zPos{ blockPos.z };
+		ConversionStats stats{};
+		BuildVoxelGrid(blocks, grid, workerPool, stats);
+	}
 
-		//Vertices
-		fwprintf_s(pOFile, L"v %.4f %.4f %.4f\n", xPos, yPos, zPos);
-		fwprintf_s(pOFile, L"v %.4f %.4f %.4f\n", xPos, yPos, zPos + 1.f);
-		fwprintf_s(pOFile, L"v %.4f %.4f %.4f\n", xPos, yPos + 1.f, zPos);
-		fwprintf_s(pOFile, L"v %.4f %.4f %.4f\n", xPos, yPos + 1.f, zPos + 1.f);
-		fwprintf_s(pOFile, L"v %.4f %.4f %.4f\n", xPos + 1.f, yPos, zPos);
-		fwprintf_s(pOFile, L"v %.4f %.4f %.4f\n", xPos + 1.f, yPos, zPos + 1.f);
-		fwprintf_s(pOFile, L"v %.4f %.4f %.4f\n", xPos + 1.f, yPos + 1.f, zPos);
-		fwprintf_s(pOFile, L"v %.4f %.4f %.4f\n", xPos + 1.f, yPos + 1.f, zPos + 1.f);
+	//Returns the ToFaceBit mask of visible faces for every block, in block order
+	inline std::vector<uint8_t> GetVisibleBlockFaces(const BlockList& blocks, const VoxelGrid& grid, WorkerPool& workerPool)
+	{
+		constexpr size_t blocksPerTask{ 4096 };
+
+		std::vector<uint8_t> visibleFaces(blocks.GetCount());
+
+		workerPool.ParallelFor(blocks.GetCount(), blocksPerTask,
+			[&blocks, &grid, &visibleFaces](const size_t begin, const size_t end, const int)
+			{
+				for (size_t i{ begin }; i < end; ++i)
+				{
+					const int x{ blocks.GetX(i) };
+					const int y{ blocks.GetY(i) };
+					const int z{ blocks.GetZ(i) };
+
+					//A transparent block sharing its position with an opaque one keeps all of its faces
+					visibleFaces[i] = (blocks.IsOpaque(i) || grid.IsOpaque(x, y, z) == false)
+						? grid.GetVisibleFaces(x, y, z)
+						: ALL_FACES_MASK;
+				}
+			}
+		);
+
+		return visibleFaces;
 	}
 
-	inline void WriteFaces(FILE* pOFile, const std::vector<Block>& blocks)
+	inline size_t CountVisibleFaces(const std::vector<uint8_t>& blockFaces)
 	{
-		std::vector<OpaqueNeighbourPos> opaqueNeighbours{};
-		std::wstring currentLayer{};
+		size_t faceCount{ 0 };
+		for (const uint8_t visibleFaces : blockFaces)
+		{
+			for (uint8_t faces{ visibleFaces }; faces != 0; faces &= faces - 1) ++faceCount;
+		}
+		return faceCount;
+	}
+
+	//Block faces covered by the quads
+	inline size_t CountQuadFaces(const std::vector<MeshQuad>& quads)
+	{
+		size_t faceCount{ 0 };
+		for (const MeshQuad& quad : quads)
+		{
+			faceCount += static_cast<size_t>(quad.size[0]) * quad.size[1] * quad.size[2];
+		}
+		return faceCount;
+	}
+
+	//Only blocks with visible faces have vertices, so vertex offsets count those blocks alone
+	//Writes the blocks in [begin, end), writtenBlockCount and currentMaterial are what the blocks before begin left behind
+	template<typename Writer>
+	inline void WriteFaces(Writer& writer, const BlockList& blocks, const std::vector<uint8_t>& blockFaces, const MaterialRegistry& materials,
+		const size_t begin, const size_t end, int writtenBlockCount, uint16_t currentMaterial)
+	{
+		COMMONCODE_TRACE_SCOPE("WriteFaces", "begin", static_cast<int64_t>(begin), "end", static_cast<int64_t>(end));
 
-		for (int i{ 0 }; i < static_cast<int>(blocks.size()); ++i)
+		for (size_t i{ begin }; i < end; ++i)
 		{
-			int idxOffset{ i * 8 };
-			const Block currentBlock{ blocks[i] };
+			const uint8_t visibleFaces{ blockFaces[i] };
+
+			//Skip fully hidden blocks
+			if (visibleFaces == 0) continue;
+
+			int idxOffset{ writtenBlockCount * 8 };
+			++writtenBlockCount;
 
 			//Check layer
-			if (currentLayer.compare(currentBlock.layerName) != 0)
+			if (currentMaterial != blocks.GetMaterialId(i))
 			{
-				currentLayer = currentBlock.layerName;
+				currentMaterial = blocks.GetMaterialId(i);
 
 				//Set material
-				fwprintf_s(pOFile, L"\n");
-				fwprintf_s(pOFile, L"usemtl %s\n", currentLayer.c_str());
+				writer.WriteMaterial(materials.GetName(currentMaterial));
 			}
 
-			//Get opaque neighbours
-			opaqueNeighbours = CheckOpaqueNeighbours(currentBlock, blocks);
-
 			//Faces
 			//Left
-			if (std::find(opaqueNeighbours.begin(), opaqueNeighbours.end(), OpaqueNeighbourPos::LEFT) == opaqueNeighbours.end())
+			if (visibleFaces & ToFaceBit(OpaqueNeighbourPos::LEFT))
 			{
-				fwprintf_s(pOFile, L"f %d/%d/%d %d/%d/%d %d/%d/%d\n", idxOffset + 1, 3, 2, idxOffset + 7, 2, 2, idxOffset + 5, 4, 2);
-				fwprintf_s(pOFile, L"f %d/%d/%d %d/%d/%d %d/%d/%d\n", idxOffset + 1, 3, 2, idxOffset + 3, 1, 2, idxOffset + 7, 2, 2);
+				writer.WriteFace(idxOffset + 1, 3, 2, idxOffset + 7, 2, 2, idxOffset + 5, 4, 2);
+				writer.WriteFace(idxOffset + 1, 3, 2, idxOffset + 3, 1, 2, idxOffset + 7, 2, 2);
 			}
 
 			//Front
-			if (std::find(opaqueNeighbours.begin(), opaqueNeighbours.end(), OpaqueNeighbourPos::FRONT) == opaqueNeighbours.end())
+			if (visibleFaces & ToFaceBit(OpaqueNeighbourPos::FRONT))
 			{
-				fwprintf_s(pOFile, L"f %d/%d/%d %d/%d/%d %d/%d/%d\n", idxOffset + 1, 4, 6, idxOffset + 4, 1, 6, idxOffset + 3, 2, 6);
-				fwprintf_s(pOFile, L"f %d/%d/%d %d/%d/%d %d/%d/%d\n", idxOffset + 1, 4, 6, idxOffset + 2, 3, 6, idxOffset + 4, 1, 6);
+				writer.WriteFace(idxOffset + 1, 4, 6, idxOffset + 4, 1, 6, idxOffset + 3, 2, 6);
+				writer.WriteFace(idxOffset + 1, 4, 6, idxOffset + 2, 3, 6, idxOffset + 4, 1, 6);
 			}
 
 			//Top
-			if (std::find(opaqueNeighbours.begin(), opaqueNeighbours.end(), OpaqueNeighbourPos::TOP) == opaqueNeighbours.end())
+			if (visibleFaces & ToFaceBit(OpaqueNeighbourPos::TOP))
 			{
-				fwprintf_s(pOFile, L"f %d/%d/%d %d/%d/%d %d/%d/%d\n", idxOffset + 3, 3, 3, idxOffset + 8, 2, 3, idxOffset + 7, 4, 3);
-				fwprintf_s(pOFile, L"f %d/%d/%d %d/%d/%d %d/%d/%d\n", idxOffset + 3, 3, 3, idxOffset + 4, 1, 3, idxOffset + 8, 2, 3);
+				writer.WriteFace(idxOffset + 3, 3, 3, idxOffset + 8, 2, 3, idxOffset + 7, 4, 3);
+				writer.WriteFace(idxOffset + 3, 3, 3, idxOffset + 4, 1, 3, idxOffset + 8, 2, 3);
 			}
 
 			//Back
-			if (std::find(opaqueNeighbours.begin(), opaqueNeighbours.end(), OpaqueNeighbourPos::BACK) == opaqueNeighbours.end())
+			if (visibleFaces & ToFaceBit(OpaqueNeighbourPos::BACK))
 			{
-				fwprintf_s(pOFile, L"f %d/%d/%d %d/%d/%d %d/%d/%d\n", idxOffset + 5, 3, 5, idxOffset + 7, 1, 5, idxOffset + 8, 2, 5);
-				fwprintf_s(pOFile, L"f %d/%d/%d %d/%d/%d %d/%d/%d\n", idxOffset + 5, 3, 5, idxOffset + 8, 2, 5, idxOffset + 6, 4, 5);
+				writer.WriteFace(idxOffset + 5, 3, 5, idxOffset + 7, 1, 5, idxOffset + 8, 2, 5);
+				writer.WriteFace(idxOffset + 5, 3, 5, idxOffset + 8, 2, 5, idxOffset + 6, 4, 5);
 			}
 
 			//Bottom
-			if (std::find(opaqueNeighbours.begin(), opaqueNeighbours.end(), OpaqueNeighbourPos::BOTTOM) == opaqueNeighbours.end())
+			if (visibleFaces & ToFaceBit(OpaqueNeighbourPos::BOTTOM))
 			{
-				fwprintf_s(pOFile, L"f %d/%d/%d %d/%d/%d %d/%d/%d\n", idxOffset + 1, 1, 4, idxOffset + 5, 2, 4, idxOffset + 6, 4, 4);
-				fwprintf_s(pOFile, L"f %d/%d/%d %d/%d/%d %d/%d/%d\n", idxOffset + 1, 1, 4, idxOffset + 6, 4, 4, idxOffset + 2, 3, 4);
+				writer.WriteFace(idxOffset + 1, 1, 4, idxOffset + 5, 2, 4, idxOffset + 6, 4, 4);
+				writer.WriteFace(idxOffset + 1, 1, 4, idxOffset + 6, 4, 4, idxOffset + 2, 3, 4);
 			}
 
 			//Right
-			if (std::find(opaqueNeighbours.begin(), opaqueNeighbours.end(), OpaqueNeighbourPos::RIGHT) == opaqueNeighbours.end())
+			if (visibleFaces & ToFaceBit(OpaqueNeighbourPos::RIGHT))
 			{
-				fwprintf_s(pOFile, L"f %d/%d/%d %d/%d/%d %d/%d/%d\n", idxOffset + 2, 4, 1, idxOffset + 6, 3, 1, idxOffset + 8, 1, 1);
-				fwprintf_s(pOFile, L"f %d/%d/%d %d/%d/%d %d/%d/%d\n", idxOffset + 2, 4, 1, idxOffset + 8, 1, 1, idxOffset + 4, 2, 1);
+				writer.WriteFace(idxOffset + 2, 4, 1, idxOffset + 6, 3, 1, idxOffset + 8, 1, 1);
+				writer.WriteFace(idxOffset + 2, 4, 1, idxOffset + 8, 1, 1, idxOffset + 4, 2, 1);
 			}
 		}
 	}
 
-	inline int ConvertJsonToObj(const std::wstring& inputFilename, const std::wstring& outputFilename, std::vector<Block>& blocks, std::wstring& message)
+	//Blocks formatted by one task when the block mesh is written in parallel
+	constexpr size_t WRITE_RANGE_SIZE{ 16 * 1024 };
+
+	//Where the text of every range of blocks goes in the output file
+	//Vertices of all ranges come first, then the faces of all ranges
+	struct BlockMeshLayout
 	{
-		if (std::ifstream is{ inputFilename })
+		std::vector<int> blockOffsets; //blocks with vertices before the range
+		std::vector<uint16_t> startMaterials; //material set when the range starts
+		std::vector<size_t> vertexOffsets;
+		std::vector<size_t> vertexSizes;
+		std::vector<size_t> faceOffsets;
+		std::vector<size_t> faceSizes;
+		size_t fileSize;
+	};
+
+	//Counts the text of every range of blocks without formatting it and places the ranges after headerSize bytes
+	inline BlockMeshLayout BuildBlockMeshLayout(const size_t headerSize, const BlockList& blocks, const std::vector<uint8_t>& blockFaces, const MaterialRegistry& materials, WorkerPool& workerPool)
+	{
+		const size_t rangeCount{ (blocks.GetCount() + WRITE_RANGE_SIZE - 1) / WRITE_RANGE_SIZE };
+
+		//Count written blocks and find the last material of every range
+		std::vector<int> rangeBlockCounts(rangeCount, 0);
+		std::vector<uint16_t> rangeMaterials(rangeCount, EMPTY_MATERIAL);
+		workerPool.ParallelFor(rangeCount, 1,
+			[&blocks, &blockFaces, &rangeBlockCounts, &rangeMaterials](const size_t begin, const size_t end, const int)
+			{
+				for (size_t rangeIdx{ begin }; rangeIdx < end; ++rangeIdx)
+				{
+					const size_t blockEnd{ (std::min)((rangeIdx + 1) * WRITE_RANGE_SIZE, blocks.GetCount()) };
+					for (size_t i{ rangeIdx * WRITE_RANGE_SIZE }; i < blockEnd; ++i)
+					{
+						if (blockFaces[i] == 0) continue;
+
+						++rangeBlockCounts[rangeIdx];
+						rangeMaterials[rangeIdx] = blocks.GetMaterialId(i);
+					}
+				}
+			}
+		);
+
+		//Prefix sums give the vertex offset and current material at the start of every range
+		BlockMeshLayout layout{};
+		layout.blockOffsets.assign(rangeCount, 0);
+		layout.startMaterials.assign(rangeCount, EMPTY_MATERIAL);
+		for (size_t rangeIdx{ 1 }; rangeIdx < rangeCount; ++rangeIdx)
+		{
+			layout.blockOffsets[rangeIdx] = layout.blockOffsets[rangeIdx - 1] + rangeBlockCounts[rangeIdx - 1];
+			layout.startMaterials[rangeIdx] = (rangeBlockCounts[rangeIdx - 1] != 0) ? rangeMaterials[rangeIdx - 1] : layout.startMaterials[rangeIdx - 1];
+		}
+
+		//Count text sizes
+		layout.vertexSizes.assign(rangeCount, 0);
+		layout.faceSizes.assign(rangeCount, 0);
+		workerPool.ParallelFor(rangeCount, 1,
+			[&blocks, &blockFaces, &materials, &layout](const size_t begin, const size_t end, const int)
+			{
+				for (size_t rangeIdx{ begin }; rangeIdx < end; ++rangeIdx)
+				{
+					const size_t blockBegin{ rangeIdx * WRITE_RANGE_SIZE };
+					const size_t blockEnd{ (std::min)(blockBegin + WRITE_RANGE_SIZE, blocks.GetCount()) };
+
+					ObjSizeCounter vertexCounter{};
+					WriteBlockVertices(vertexCounter, blocks, blockFaces, blockBegin, blockEnd);
+					layout.vertexSizes[rangeIdx] = vertexCounter.GetSize();
+
+					ObjSizeCounter faceCounter{};
+					WriteFaces(faceCounter, blocks, blockFaces, materials, blockBegin, blockEnd, layout.blockOffsets[rangeIdx], layout.startMaterials[rangeIdx]);
+					layout.faceSizes[rangeIdx] = faceCounter.GetSize();
+				}
+			}
+		);
+
+		//Prefix sums of the sizes give the file offsets
+		layout.vertexOffsets.assign(rangeCount, 0);
+		layout.faceOffsets.assign(rangeCount, 0);
+		layout.fileSize = headerSize;
+		for (size_t rangeIdx{ 0 }; rangeIdx < rangeCount; ++rangeIdx)
+		{
+			layout.vertexOffsets[rangeIdx] = layout.fileSize;
+			layout.fileSize += layout.vertexSizes[rangeIdx];
+		}
+		for (size_t rangeIdx{ 0 }; rangeIdx < rangeCount; ++rangeIdx)
 		{
-			rapidjson::IStreamWrapper isw{ is };
-			rapidjson::Document sceneDoc;
-			sceneDoc.ParseStream(isw);
+			layout.faceOffsets[rangeIdx] = layout.fileSize;
+			layout.fileSize += layout.faceSizes[rangeIdx];
+		}
+
+		return layout;
+	}
+
+	//Writes the vertices of every block with visible faces, then their faces, at the offsets of the layout
+	//Every thread formats a range into its own buffer and copies it to its place in the output, so ranges are written in any order
+	//Vertices and faces are written in separate passes so their times can be told apart
+	//Returns false if a range didn't have the counted size
+	inline bool WriteBlockMesh(char* pOutput, const BlockMeshLayout& layout, const BlockList& blocks, const std::vector<uint8_t>& blockFaces, const MaterialRegistry& materials, WorkerPool& workerPool, ConversionStats& stats)
+	{
+		std::vector<ObjWriter> threadWriters(workerPool.GetThreadCount());
+		std::atomic<bool> isLayoutValid{ true };
 
-			if (sceneDoc.IsArray())
+		auto copyRange = [pOutput, &isLayoutValid](const ObjWriter& rangeWriter, const size_t offset, const size_t size)
+		{
+			if (rangeWriter.GetSize() != size)
 			{
-				FILE* pOFile = nullptr;
-				_wfopen_s(&pOFile, outputFilename.c_str(), L"w+,ccs=UTF-8");
+				isLayoutValid = false;
+				return;
+			}
+			memcpy(pOutput + offset, rangeWriter.GetData(), size);
+		};
 
-				if (pOFile != nullptr) //File was succesfully created
+		//Add vertices of blocks that are not fully hidden
+		{
+			PhaseTimer timer{ stats, ConversionPhase::VERTEX_WRITE };
+			workerPool.ParallelFor(layout.blockOffsets.size(), 1,
+				[&](const size_t begin, const size_t end, const int threadIdx)
 				{
-					//Initialize file with comment
-					const wchar_t* text = L"#Minecraft Scene\n\n";
-					fwrite(text, wcslen(text) * sizeof(wchar_t), 1, pOFile);
-
-					//Declare materials
-					fwprintf_s(pOFile, L"mtllib Resources/minecraftMats.mtl\n\n");
-
-					//Add normals
-					fwprintf_s(pOFile, L"vn %.4f %.4f %.4f\n", 0.f, 0.f, 1.f);
-					fwprintf_s(pOFile, L"vn %.4f %.4f %.4f\n", 0.f, 0.f, -1.f);
-					fwprintf_s(pOFile, L"vn %.4f %.4f %.4f\n", 0.f, 1.f, 0.f);
-					fwprintf_s(pOFile, L"vn %.4f %.4f %.4f\n", 0.f, -1.f, 0.f);
-					fwprintf_s(pOFile, L"vn %.4f %.4f %.4f\n", 1.f, 0.f, 0.f);
-					fwprintf_s(pOFile, L"vn %.4f %.4f %.4f\n", -1.f, 0.f, 0.f);
-
-					//Add texture coordinates
-					fwprintf_s(pOFile, L"vt %.4f %.4f\n", 0.f, 0.f);
-					fwprintf_s(pOFile, L"vt %.4f %.4f\n", 1.f, 0.f);
-					fwprintf_s(pOFile, L"vt %.4f %.4f\n", 0.f, 1.f);
-					fwprintf_s(pOFile, L"vt %.4f %.4f\n", 1.f, 1.f);
-					fwprintf_s(pOFile, L"\n");
-
-					//Write blocks
-					for (rapidjson::Value::ConstValueIterator layerIt = sceneDoc.Begin(); layerIt != sceneDoc.End(); ++layerIt)
+					ObjWriter& rangeWriter{ threadWriters[threadIdx] };
+
+					for (size_t rangeIdx{ begin }; rangeIdx < end; ++rangeIdx)
 					{
-						const rapidjson::Value& layer{ *layerIt };
-
-						if (layer.HasMember("layer") && layer.HasMember("opaque") && layer.HasMember("positions"))
-						{
-							const rapidjson::Value& layerName{ layer["layer"] };
-							const rapidjson::Value& isOpaque{ layer["opaque"] };
-							const rapidjson::Value& positions{ layer["positions"] };
-
-							if (layerName.IsString() && isOpaque.IsBool() && positions.IsArray())
-							{
-								//Add blocks
-								for (rapidjson::Value::ConstValueIterator blockIt = positions.Begin(); blockIt != positions.End(); ++blockIt)
-								{
-									const rapidjson::Value& pos{ *blockIt };
-
-									if (pos.IsArray() && pos.Size() == 3)
-									{
-										const rapidjson::Value& x{ pos[1] };
-										const rapidjson::Value& y{ pos[2] };
-										const rapidjson::Value& z{ pos[0] };
-
-										if (x.IsInt() && y.IsInt() && z.IsInt())
-										{
-											//Convert layer name to wstring
-											const std::string layerNameStr{ layerName.GetString() };
-											const size_t layerNameStrLen{ static_cast<size_t>(layerNameStr.length()) };
-											wchar_t* layerNameWStr = new wchar_t[layerNameStrLen + 1];
-											mbstowcs_s(NULL, layerNameWStr, layerNameStrLen + 1, layerNameStr.c_str(), layerNameStrLen);
-											layerNameWStr[0] -= 32; //Capitalize first character
-
-											//Create block
-											Block block{
-												std::wstring{ layerNameWStr },
-												isOpaque.GetBool(),
-												Vector3f{ x.GetInt(), y.GetInt(), z.GetInt() }
-											};
-											blocks.push_back(block);
-											delete[] layerNameWStr;
-
-											//Add vertices
-											WriteVertices(pOFile, block.pos);
-										}
-										else
-										{
-											wprintf_s(L"Failed to parse block!\n");
-											continue;
-										}
-									}
-									else
-									{
-										wprintf_s(L"Failed to parse block!\n");
-										continue;
-									}
-								}
-							}
-							else
-							{
-								wprintf_s(L"Failed to parse layer!\n");
-								continue;
-							}
-						}
-						else
-						{
-							wprintf_s(L"Failed to parse layer!\n");
-							continue;
-						}
+						const size_t blockBegin{ rangeIdx * WRITE_RANGE_SIZE };
+						const size_t blockEnd{ (std::min)(blockBegin + WRITE_RANGE_SIZE, blocks.GetCount()) };
+
+						rangeWriter.Clear();
+						WriteBlockVertices(rangeWriter, blocks, blockFaces, blockBegin, blockEnd);
+						copyRange(rangeWriter, layout.vertexOffsets[rangeIdx], layout.vertexSizes[rangeIdx]);
 					}
+				}
+			);
+		}
+
+		//Add faces
+		PhaseTimer timer{ stats, ConversionPhase::FACE_WRITE };
+		workerPool.ParallelFor(layout.blockOffsets.size(), 1,
+			[&](const size_t begin, const size_t end, const int threadIdx)
+			{
+				ObjWriter& rangeWriter{ threadWriters[threadIdx] };
 
-					//Add faces
-					WriteFaces(pOFile, blocks);
+				for (size_t rangeIdx{ begin }; rangeIdx < end; ++rangeIdx)
+				{
+					const size_t blockBegin{ rangeIdx * WRITE_RANGE_SIZE };
+					const size_t blockEnd{ (std::min)(blockBegin + WRITE_RANGE_SIZE, blocks.GetCount()) };
 
-					fclose(pOFile);
-					message = L"Output file was succesfully created!\n";
-					return 0;
+					rangeWriter.Clear();
+					WriteFaces(rangeWriter, blocks, blockFaces, materials, blockBegin, blockEnd, layout.blockOffsets[rangeIdx], layout.startMaterials[rangeIdx]);
+					copyRange(rangeWriter, layout.faceOffsets[rangeIdx], layout.faceSizes[rangeIdx]);
 				}
-				else
+			}
+		);
+
+		return isLayoutValid;
+	}
+
+	//Turns the visible faces of every block into unit quads, in the order WriteFaces writes them
+	inline std::vector<MeshQuad> BuildBlockQuads(const BlockList& blocks, const std::vector<uint8_t>& blockFaces)
+	{
+		std::vector<MeshQuad> quads{};
+
+		for (size_t i{ 0 }; i < blocks.GetCount(); ++i)
+		{
+			for (const OpaqueNeighbourPos face : BLOCK_FACE_ORDER)
+			{
+				if ((blockFaces[i] & ToFaceBit(face)) == 0) continue;
+
+				quads.push_back(MeshQuad{
+					{ blocks.GetX(i), blocks.GetY(i), blocks.GetZ(i) },
+					{ 1, 1, 1 },
+					blocks.GetMaterialId(i),
+					static_cast<uint8_t>(face)
+				});
+			}
+		}
+
+		return quads;
+	}
+
+	//Writes quads with texture coordinates scaled by the quad size so textures repeat per block
+	//Welding shares vertices between quads, otherwise every quad gets 4 vertices of its own
+	inline void WriteQuadMesh(ObjWriter& writer, const std::vector<MeshQuad>& quads, const std::vector<std::wstring>& layerNames, const bool weldVertices, ConversionStats& stats)
+	{
+		PhaseTimer vertexTimer{ stats, ConversionPhase::VERTEX_WRITE };
+
+		//Texture coordinates, the 4 unit coordinates are already in the file
+		std::map<std::pair<int, int>, int> texCoordOffsets{ { { 1, 1 }, 0 } };
+		for (const MeshQuad& quad : quads)
+		{
+			const CubeFace& cubeFace{ CUBE_FACES[quad.face] };
+			const std::pair<int, int> texCoordScale{ quad.size[cubeFace.sAxis], quad.size[cubeFace.tAxis] };
+
+			if (texCoordOffsets.find(texCoordScale) == texCoordOffsets.end())
+			{
+				//Counted before the insert, operator[] may add the key before the right side is evaluated
+				const int texCoordOffset{ static_cast<int>(texCoordOffsets.size()) * 4 };
+				texCoordOffsets.emplace(texCoordScale, texCoordOffset);
+
+				writer.WriteTexCoord(0, 0);
+				writer.WriteTexCoord(texCoordScale.first, 0);
+				writer.WriteTexCoord(0, texCoordScale.second);
+				writer.WriteTexCoord(texCoordScale.first, texCoordScale.second);
+			}
+		}
+		writer.Write("\n");
+
+		const std::vector<QuadCorners> quadCorners{ BuildQuadCorners() };
+
+		//Vertices
+		std::vector<int> quadVertexIndices(quads.size() * 4);
+		if (weldVertices)
+		{
+			VertexWelder welder{ quads.size() };
+			for (size_t i{ 0 }; i < quads.size(); ++i)
+			{
+				const MeshQuad& quad{ quads[i] };
+				for (int corner{ 0 }; corner < 4; ++corner)
 				{
-					message = L"Failed to create output file!\n";
-					return -1;
+					const int vertexIdx{ quadCorners[quad.face].vertexIndices[corner] };
+					quadVertexIndices[i * 4 + corner] = welder.GetVertexIdx(
+						quad.pos[0] + GetCubeVertexOffset(vertexIdx, 0) * quad.size[0],
+						quad.pos[1] + GetCubeVertexOffset(vertexIdx, 1) * quad.size[1],
+						quad.pos[2] + GetCubeVertexOffset(vertexIdx, 2) * quad.size[2]
+					);
 				}
 			}
-			else
+
+			const std::vector<int>& positions{ welder.GetPositions() };
+			for (size_t i{ 0 }; i < positions.size(); i += 3)
 			{
-				message = L"Failed to parse input file!\n";
-				return -1;
+				writer.WriteVertex(positions[i], positions[i + 1], positions[i + 2]);
 			}
 		}
 		else
 		{
-			message = L"Couldn't find input file!\n";
-			return -1;
+			for (size_t i{ 0 }; i < quads.size(); ++i)
+			{
+				const MeshQuad& quad{ quads[i] };
+				for (int corner{ 0 }; corner < 4; ++corner)
+				{
+					const int vertexIdx{ quadCorners[quad.face].vertexIndices[corner] };
+					quadVertexIndices[i * 4 + corner] = static_cast<int>(i * 4) + corner + 1;
+
+					writer.WriteVertex(
+						quad.pos[0] + GetCubeVertexOffset(vertexIdx, 0) * quad.size[0],
+						quad.pos[1] + GetCubeVertexOffset(vertexIdx, 1) * quad.size[1],
+						quad.pos[2] + GetCubeVertexOffset(vertexIdx, 2) * quad.size[2]
+					);
+				}
+			}
+		}
+
+		//Faces
+		vertexTimer.Stop();
+		PhaseTimer faceTimer{ stats, ConversionPhase::FACE_WRITE };
+
+		uint16_t currentMaterial{ EMPTY_MATERIAL };
+		for (size_t i{ 0 }; i < quads.size(); ++i)
+		{
+			const MeshQuad& quad{ quads[i] };
+			const CubeFace& cubeFace{ CUBE_FACES[quad.face] };
+			const int* pVertexIndices{ &quadVertexIndices[i * 4] };
+			const int texCoordOffset{ texCoordOffsets[{ quad.size[cubeFace.sAxis], quad.size[cubeFace.tAxis] }] };
+
+			//Check layer
+			if (quad.materialId != currentMaterial)
+			{
+				currentMaterial = quad.materialId;
+
+				//Set material
+				writer.WriteMaterial(layerNames[currentMaterial]);
+			}
+
+			for (int triangle{ 0 }; triangle < 2; ++triangle)
+			{
+				const int* pCorners{ &quadCorners[quad.face].triangles[triangle * 3] };
+				const int* pTexCoords{ &cubeFace.texCoordIndices[triangle * 3] };
+
+				writer.WriteFace(
+					pVertexIndices[pCorners[0]], texCoordOffset + pTexCoords[0], cubeFace.normalIdx,
+					pVertexIndices[pCorners[1]], texCoordOffset + pTexCoords[1], cubeFace.normalIdx,
+					pVertexIndices[pCorners[2]], texCoordOffset + pTexCoords[2], cubeFace.normalIdx
+				);
+			}
+		}
+	}
+
+	//Converts a layer name to the capitalized wide string used for materials
+	inline std::wstring ToLayerName(const char* layerName, const size_t length)
+	{
+		wchar_t* layerNameWStr = new wchar_t[length + 1];
+		mbstowcs_s(NULL, layerNameWStr, length + 1, layerName, length);
+		layerNameWStr[0] -= 32; //Capitalize first character
+
+		const std::wstring layerNameStr{ layerNameWStr };
+		delete[] layerNameWStr;
+		return layerNameStr;
+	}
+
+	//Part of a scene file a SceneHandler reads
+	enum class SceneRange
+	{
+		SCENE, //the whole scene array
+		LAYERS, //layer objects, without the surrounding scene array
+		POSITIONS, //elements of a positions array, only queued and counted since the layer isn't known
+	};
+
+	//Parts of a scene that were skipped because they were malformed
+	//Counted instead of listed, so their memory doesn't grow with the size of the file
+	struct SceneWarnings
+	{
+		size_t failedBlockCount{ 0 };
+		size_t failedLayerCount{ 0 };
+
+		void Add(const SceneWarnings& other)
+		{
+			failedBlockCount += other.failedBlockCount;
+			failedLayerCount += other.failedLayerCount;
+		}
+	};
+
+	//One line per kind of warning, empty when nothing was skipped
+	inline std::wstring FormatSceneWarnings(const SceneWarnings& warnings)
+	{
+		std::wstring text{ L"" };
+		if (warnings.failedLayerCount == 1) text += L"Failed to parse 1 layer!\n";
+		else if (warnings.failedLayerCount > 1) text += L"Failed to parse " + std::to_wstring(warnings.failedLayerCount) + L" layers!\n";
+		if (warnings.failedBlockCount == 1) text += L"Failed to parse 1 block!\n";
+		else if (warnings.failedBlockCount > 1) text += L"Failed to parse " + std::to_wstring(warnings.failedBlockCount) + L" blocks!\n";
+		return text;
+	}
+
+	//SAX handler that reads the scene array straight into blocks, without building a document
+	//Expects [ { "layer": string, "opaque": bool, "positions": [ [z, x, y], ... ] }, ... ]
+	//Warnings are counted instead of printed, so ranges parsed in parallel can be reported together
+	class SceneHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, SceneHandler>
+	{
+	public:
+		SceneHandler(BlockList& blocks, MaterialRegistry& materials, const SceneRange range = SceneRange::SCENE)
+			: m_Blocks{ blocks }
+			, m_Materials{ materials }
+			, m_Range{ range }
+		{
+			if (range == SceneRange::LAYERS) m_State = State::SCENE;
+			else if (range == SceneRange::POSITIONS) m_State = State::POSITIONS;
+		}
+
+		bool Default()
+		{
+			return Value(ValueType::OTHER);
+		}
+		bool Bool(bool value)
+		{
+			if (m_SkipDepth == 0 && m_State == State::LAYER && m_Key == LayerKey::OPAQUE)
+			{
+				m_Layer.isOpaque = value;
+				m_Layer.hasOpaque = true;
+			}
+			return Value(ValueType::OTHER);
+		}
+		bool Int(int value)
+		{
+			return Number(value);
+		}
+		bool Uint(unsigned value)
+		{
+			return (value <= static_cast<unsigned>(INT_MAX)) ? Number(static_cast<int>(value)) : Default();
+		}
+		bool String(const char* value, rapidjson::SizeType length, bool)
+		{
+			if (m_SkipDepth == 0 && m_State == State::LAYER && m_Key == LayerKey::LAYER)
+			{
+				m_Layer.materialId = m_Materials.GetMaterialId(ToLayerName(value, length));
+				m_Layer.hasName = m_Layer.materialId != EMPTY_MATERIAL;
+			}
+			return Value(ValueType::OTHER);
+		}
+		bool Key(const char* key, rapidjson::SizeType length, bool)
+		{
+			if (m_SkipDepth == 0 && m_State == State::LAYER)
+			{
+				const std::string keyStr{ key, length };
+				if (keyStr == "layer") m_Key = LayerKey::LAYER;
+				else if (keyStr == "opaque") m_Key = LayerKey::OPAQUE;
+				else if (keyStr == "positions") m_Key = LayerKey::POSITIONS;
+				else m_Key = LayerKey::OTHER;
+			}
+			return true;
+		}
+		bool StartObject()
+		{
+			if (m_SkipDepth == 0 && m_State == State::SCENE)
+			{
+				//Start layer
+				m_State = State::LAYER;
+				m_Key = LayerKey::OTHER;
+				m_Layer = LayerInfo{};
+				m_Layer.firstBlockIdx = m_Blocks.GetCount();
+				return true;
+			}
+			return Value(ValueType::CONTAINER);
+		}
+		bool EndObject(rapidjson::SizeType)
+		{
+			if (m_SkipDepth > 0) return EndContainer();
+
+			//End layer
+			m_State = State::SCENE;
+
+			if (m_Layer.hasName && m_Layer.hasOpaque && m_Layer.hasPositions)
+			{
+				for (size_t i{ 0 }; i < m_Layer.pendingPositions.size(); i += 3)
+				{
+					AddBlock(m_Layer.pendingPositions[i], m_Layer.pendingPositions[i + 1], m_Layer.pendingPositions[i + 2]);
+				}
+				m_Warnings.failedBlockCount += static_cast<size_t>(m_Layer.failedBlockCount);
+
+				m_LastLayerMaterialId = m_Layer.materialId;
+				m_IsLastLayerOpaque = m_Layer.isOpaque;
+			}
+			else
+			{
+				//Drop blocks that were added before the layer turned out to be invalid
+				m_Blocks.Truncate(m_Layer.firstBlockIdx);
+				++m_Warnings.failedLayerCount;
+
+				m_LastLayerMaterialId = EMPTY_MATERIAL;
+			}
+			return true;
+		}
+		bool StartArray()
+		{
+			if (m_SkipDepth == 0)
+			{
+				switch (m_State)
+				{
+				case State::START:
+					m_State = State::SCENE;
+					return true;
+				case State::LAYER:
+					if (m_Key == LayerKey::POSITIONS)
+					{
+						m_State = State::POSITIONS;
+						m_Layer.hasPositions = true;
+						return true;
+					}
+					break;
+				case State::POSITIONS:
+					m_State = State::POSITION;
+					m_PositionSize = 0;
+					m_IsPositionValid = true;
+					return true;
+				default:
+					break;
+				}
+			}
+			return Value(ValueType::CONTAINER);
 		}
+		bool EndArray(rapidjson::SizeType)
+		{
+			if (m_SkipDepth > 0) return EndContainer();
+
+			switch (m_State)
+			{
+			case State::SCENE:
+				m_State = State::END;
+				break;
+			case State::POSITIONS:
+				m_State = State::LAYER;
+				m_Key = LayerKey::OTHER;
+				break;
+			case State::POSITION:
+				m_State = State::POSITIONS;
+				if (m_IsPositionValid && m_PositionSize == 3)
+				{
+					//Positions are stored as z, x, y
+					AddOrQueueBlock(m_Position[1], m_Position[2], m_Position[0]);
+				}
+				else
+				{
+					++m_Layer.failedBlockCount;
+				}
+				break;
+			default:
+				break;
+			}
+			return true;
+		}
+
+		//Only true when the input held exactly the range the handler was made for
+		bool IsComplete() const
+		{
+			switch (m_Range)
+			{
+			case SceneRange::LAYERS: return m_State == State::SCENE;
+			case SceneRange::POSITIONS: return m_State == State::POSITIONS;
+			case SceneRange::SCENE:
+			default: return m_State == State::END;
+			}
+		}
+
+		const SceneWarnings& GetWarnings() const { return m_Warnings; }
+
+		//Material of the last layer that ended, EMPTY_MATERIAL when it was invalid
+		uint16_t GetLastLayerMaterialId() const { return m_LastLayerMaterialId; }
+		bool IsLastLayerOpaque() const { return m_IsLastLayerOpaque; }
+
+		//Positions read in a POSITIONS range as x, y, z, and the number of elements that weren't positions
+		void TakeQueuedPositions(std::vector<int>& positions) { positions.swap(m_Layer.pendingPositions); }
+		int GetFailedBlockCount() const { return m_Layer.failedBlockCount; }
+
+	private:
+		enum class State
+		{
+			START,
+			SCENE,
+			LAYER,
+			POSITIONS,
+			POSITION,
+			END,
+		};
+
+		enum class LayerKey
+		{
+			OTHER,
+			LAYER,
+			OPAQUE,
+			POSITIONS,
+		};
+
+		enum class ValueType
+		{
+			OTHER,
+			CONTAINER,
+		};
+
+		struct LayerInfo
+		{
+			uint16_t materialId{ EMPTY_MATERIAL };
+			bool isOpaque{ false };
+			bool hasName{ false };
+			bool hasOpaque{ false };
+			bool hasPositions{ false };
+			size_t firstBlockIdx{ 0 };
+			int failedBlockCount{ 0 };
+			std::vector<int> pendingPositions{}; //positions read before the name and opacity were known
+		};
+
+		BlockList& m_Blocks;
+		MaterialRegistry& m_Materials;
+		const SceneRange m_Range;
+
+		State m_State{ State::START };
+		LayerKey m_Key{ LayerKey::OTHER };
+		LayerInfo m_Layer{};
+		int m_SkipDepth{ 0 };
+		SceneWarnings m_Warnings{};
+
+		uint16_t m_LastLayerMaterialId{ EMPTY_MATERIAL };
+		bool m_IsLastLayerOpaque{ false };
+
+		int m_Position[3]{};
+		int m_PositionSize{ 0 };
+		bool m_IsPositionValid{ false };
+
+		bool Number(const int value)
+		{
+			if (m_SkipDepth == 0 && m_State == State::POSITION)
+			{
+				if (m_PositionSize < 3) m_Position[m_PositionSize] = value;
+				++m_PositionSize;
+				return true;
+			}
+			return Value(ValueType::OTHER);
+		}
+
+		//Handles any value the scene layout does not use at this point
+		bool Value(const ValueType valueType)
+		{
+			if (m_SkipDepth == 0)
+			{
+				switch (m_State)
+				{
+				case State::START: //Scene is not an array
+				case State::END: //Data after the scene
+					return false;
+				case State::SCENE: //Layer is not an object
+					++m_Warnings.failedLayerCount;
+					break;
+				case State::LAYER:
+					//A known key with the wrong type invalidates the layer
+					if (m_Key == LayerKey::LAYER && valueType == ValueType::CONTAINER) m_Layer.hasName = false;
+					else if (m_Key == LayerKey::OPAQUE && valueType == ValueType::CONTAINER) m_Layer.hasOpaque = false;
+					else if (m_Key == LayerKey::POSITIONS) m_Layer.hasPositions = false;
+					break;
+				case State::POSITIONS: //Block is not an array
+					++m_Layer.failedBlockCount;
+					break;
+				case State::POSITION: //Coordinate is not an int
+					m_IsPositionValid = false;
+					break;
+				}
+			}
+
+			if (valueType == ValueType::CONTAINER) ++m_SkipDepth;
+			return true;
+		}
+
+		bool EndContainer()
+		{
+			--m_SkipDepth;
+			return true;
+		}
+
+		void AddOrQueueBlock(const int x, const int y, const int z)
+		{
+			if (m_Layer.hasName && m_Layer.hasOpaque)
+			{
+				AddBlock(x, y, z);
+			}
+			else
+			{
+				m_Layer.pendingPositions.insert(m_Layer.pendingPositions.end(), { x, y, z });
+			}
+		}
+
+		void AddBlock(const int x, const int y, const int z)
+		{
+			m_Blocks.Add(x, y, z, m_Layer.materialId, m_Layer.isOpaque);
+		}
+	};
+
+	//Reads the blocks of a scene from any rapidjson input stream, returns false when it isn't a valid scene
+	//Skipped layers and blocks are added to warnings, they are left to the caller to report
+	template<typename InputStream>
+	bool ParseScene(InputStream& stream, BlockList& blocks, MaterialRegistry& materials, SceneWarnings& warnings)
+	{
+		rapidjson::Reader reader{};
+		SceneHandler sceneHandler{ blocks, materials };
+		reader.Parse<rapidjson::kParseIterativeFlag>(stream, sceneHandler);
+
+		warnings.Add(sceneHandler.GetWarnings());
+		return sceneHandler.IsComplete() && reader.HasParseError() == false;
+	}
+
+	//Parses comma separated values with the handler, returns false on syntax errors
+	inline bool ParseJsonRange(const JsonRange& range, SceneHandler& sceneHandler, const SimdLevel simdLevel)
+	{
+		ScanMemoryStream ms{ range.pBegin, static_cast<size_t>(range.pEnd - range.pBegin), simdLevel };
+		rapidjson::Reader reader{};
+
+		while (true)
+		{
+			reader.Parse<rapidjson::kParseIterativeFlag | rapidjson::kParseStopWhenDoneFlag>(ms, sceneHandler);
+			if (reader.HasParseError()) return false;
+
+			rapidjson::SkipWhitespace(ms);
+			if (ms.Tell() == ms.size_) return true;
+			if (ms.Take() != ',') return false;
+		}
+	}
+
+	//Layers and positions arrays larger than this are split between parse tasks
+	constexpr size_t PARSE_RANGE_SIZE{ 256 * 1024 };
+
+	//Layer object of a scene file as found by ScanSceneLayout
+	struct LayerLayout
+	{
+		JsonRange range; //layer element, with surrounding whitespace
+		JsonRange positions; //positions array with its brackets, empty unless the layer has exactly one
+		std::vector<JsonRange> positionRanges; //elements of positions grouped into ranges of at least minRangeSize bytes
+	};
+
+	//Finds the layers of a scene and the elements of their positions arrays in one pass over the structural characters
+	//Nothing is validated beyond matching brackets, the ranges still have to be parsed to find syntax errors
+	//Returns the position after the scene array, or nullptr when no closed array was found
+	inline const char* ScanSceneLayout(const char* pData, const char* pEnd, const size_t minRangeSize, std::vector<LayerLayout>& layers, const SimdLevel simdLevel)
+	{
+		const FindJsonStructuralFunc findStructural{ GetFindJsonStructuralFunc(simdLevel) };
+
+		const char* p{ SkipJsonWhitespaceScalar(pData, pEnd) };
+		if (p == pEnd || *p != '[') return nullptr;
+
+		int depth{ 1 };
+		LayerLayout layer{ JsonRange{ p + 1, p + 1 }, JsonRange{ nullptr, nullptr }, {} };
+		int positionsKeyCount{ 0 };
+		bool isKeyNext{ false };
+		bool isPositionsKey{ false };
+		bool isInPositions{ false };
+		const char* pRangeBegin{ nullptr };
+
+		auto endLayer = [&](const char* pLayerEnd)
+		{
+			layer.range.pEnd = pLayerEnd;
+			if (positionsKeyCount != 1 || layer.positions.pEnd == nullptr)
+			{
+				layer.positions = JsonRange{ nullptr, nullptr };
+				layer.positionRanges.clear();
+			}
+			layers.push_back(std::move(layer));
+
+			layer = LayerLayout{ JsonRange{ pLayerEnd + 1, pLayerEnd + 1 }, JsonRange{ nullptr, nullptr }, {} };
+			positionsKeyCount = 0;
+			isKeyNext = false;
+			isPositionsKey = false;
+		};
+
+		for (p = findStructural(p + 1, pEnd); p != pEnd; p = findStructural(p + 1, pEnd))
+		{
+			switch (*p)
+			{
+			case '"':
+			{
+				const char* pString{ p + 1 };
+				while (true)
+				{
+					p = findStructural(p + 1, pEnd);
+					if (p == pEnd) return nullptr;
+					if (*p == '"') break;
+					if (*p == '\\' && ++p == pEnd) return nullptr;
+				}
+
+				//Keys are compared as written, so escaped keys never match
+				if (depth == 2 && isKeyNext)
+				{
+					isKeyNext = false;
+					isPositionsKey = std::string{ pString, p }.compare("positions") == 0;
+					if (isPositionsKey) ++positionsKeyCount;
+				}
+				break;
+			}
+			case '[':
+			case '{':
+				if (depth == 1)
+				{
+					isKeyNext = *p == '{';
+				}
+				else if (depth == 2 && isPositionsKey && *p == '[')
+				{
+					isInPositions = true;
+					layer.positions.pBegin = p;
+					pRangeBegin = p + 1;
+				}
+				isPositionsKey = false;
+				++depth;
+				break;
+			case ']':
+			case '}':
+				--depth;
+				if (depth == 0)
+				{
+					if (*p != '}')
+					{
+						//An empty scene has no layers, an empty last layer is kept so parsing fails on it
+						if (layers.empty() == false || SkipJsonWhitespaceScalar(layer.range.pBegin, p) != p) endLayer(p);
+						return p + 1;
+					}
+					return nullptr;
+				}
+				else if (depth == 2 && isInPositions)
+				{
+					isInPositions = false;
+					layer.positions.pEnd = p + 1;
+					if (layer.positionRanges.empty() == false || SkipJsonWhitespaceScalar(pRangeBegin, p) != p)
+					{
+						layer.positionRanges.push_back(JsonRange{ pRangeBegin, p });
+					}
+				}
+				break;
+			case ',':
+				if (depth == 1)
+				{
+					endLayer(p);
+				}
+				else if (depth == 2)
+				{
+					isKeyNext = true;
+					isPositionsKey = false;
+				}
+				else if (depth == 3 && isInPositions && static_cast<size_t>(p - pRangeBegin) >= minRangeSize)
+				{
+					layer.positionRanges.push_back(JsonRange{ pRangeBegin, p });
+					pRangeBegin = p + 1;
+				}
+				break;
+			default: //backslash outside of a string
+				break;
+			}
+		}
+
+		return nullptr;
+	}
+
+
+	//Parses the layers of a scene on all threads of the pool and joins their blocks in file order
+	//Large positions arrays are split at element boundaries, their layer is then read with an empty positions array
+	//Falls back to a single-threaded parse when the ranges can't be found or one of them fails, so errors are reported the same way
+	inline bool ParseSceneParallel(const char* pData, const size_t size, BlockList& blocks, MaterialRegistry& materials, SceneWarnings& warnings, WorkerPool& workerPool, const SimdLevel simdLevel)
+	{
+		auto parseScene = [&]()
+		{
+			ScanMemoryStream ms{ pData, size, simdLevel };
+			return ParseScene(ms, blocks, materials, warnings);
+		};
+
+		//Find layers and split large positions arrays
+		std::vector<LayerLayout> layers{};
+		const char* pEnd{ pData + size };
+		const char* pSceneEnd{ ScanSceneLayout(pData, pEnd, PARSE_RANGE_SIZE, layers, simdLevel) };
+		if (pSceneEnd == nullptr || SkipJsonWhitespaceScalar(pSceneEnd, pEnd) != pEnd) return parseScene();
+
+		//Small layers are parsed whole, split layers are read with an empty positions array
+		std::vector<std::string> splitLayerTexts(layers.size());
+		for (size_t layerIdx{ 0 }; layerIdx < layers.size(); ++layerIdx)
+		{
+			LayerLayout& layer{ layers[layerIdx] };
+			if (static_cast<size_t>(layer.range.pEnd - layer.range.pBegin) < PARSE_RANGE_SIZE || layer.positionRanges.empty())
+			{
+				layer.positionRanges.clear();
+				continue;
+			}
+
+			std::string& layerText{ splitLayerTexts[layerIdx] };
+			layerText.assign(layer.range.pBegin, layer.positions.pBegin);
+			layerText += "[]";
+			layerText.append(layer.positions.pEnd, layer.range.pEnd);
+		}
+
+		//Parse ranges
+		struct ParseTask
+		{
+			JsonRange range;
+			SceneRange sceneRange;
+		};
+
+		struct ParseResult
+		{
+			BlockList blocks{};
+			MaterialRegistry materials{};
+			SceneWarnings warnings{};
+			std::vector<int> positions{};
+			int failedBlockCount{ 0 };
+			uint16_t lastLayerMaterialId{ EMPTY_MATERIAL };
+			bool isLastLayerOpaque{ false };
+			bool isParsed{ false };
+		};
+
+		std::vector<ParseTask> tasks{};
+		for (size_t layerIdx{ 0 }; layerIdx < layers.size(); ++layerIdx)
+		{
+			const LayerLayout& layer{ layers[layerIdx] };
+			if (layer.positionRanges.empty())
+			{
+				tasks.push_back(ParseTask{ layer.range, SceneRange::LAYERS });
+				continue;
+			}
+
+			const std::string& layerText{ splitLayerTexts[layerIdx] };
+			tasks.push_back(ParseTask{ JsonRange{ layerText.data(), layerText.data() + layerText.size() }, SceneRange::LAYERS });
+			for (const JsonRange& positionRange : layer.positionRanges)
+			{
+				tasks.push_back(ParseTask{ positionRange, SceneRange::POSITIONS });
+			}
+		}
+
+		std::vector<ParseResult> results(tasks.size());
+		workerPool.ParallelFor(tasks.size(), 1,
+			[&tasks, &results, simdLevel](const size_t begin, const size_t end, const int)
+			{
+				for (size_t taskIdx{ begin }; taskIdx < end; ++taskIdx)
+				{
+					COMMONCODE_TRACE_SCOPE("parse range", "task", static_cast<int64_t>(taskIdx));
+					ParseResult& result{ results[taskIdx] };
+					SceneHandler sceneHandler{ result.blocks, result.materials, tasks[taskIdx].sceneRange };
+
+					result.isParsed = ParseJsonRange(tasks[taskIdx].range, sceneHandler, simdLevel) && sceneHandler.IsComplete();
+					result.warnings = sceneHandler.GetWarnings();
+					result.lastLayerMaterialId = sceneHandler.GetLastLayerMaterialId();
+					result.isLastLayerOpaque = sceneHandler.IsLastLayerOpaque();
+					result.failedBlockCount = sceneHandler.GetFailedBlockCount();
+					sceneHandler.TakeQueuedPositions(result.positions);
+				}
+			}
+		);
+
+		for (const ParseResult& result : results)
+		{
+			if (result.isParsed == false) return parseScene();
+		}
+
+		//Join layers in file order
+		size_t blockCount{ blocks.GetCount() };
+		for (const ParseResult& result : results)
+		{
+			blockCount += result.blocks.GetCount() + result.positions.size() / 3;
+		}
+		blocks.Reserve(blockCount);
+
+		size_t taskIdx{ 0 };
+		for (const LayerLayout& layer : layers)
+		{
+			const ParseResult& layerResult{ results[taskIdx++] };
+
+			//Register names in the order the layers use them
+			std::vector<uint16_t> materialIds(layerResult.materials.GetCount());
+			for (uint16_t materialId{ 0 }; materialId < layerResult.materials.GetCount(); ++materialId)
+			{
+				materialIds[materialId] = materials.GetMaterialId(layerResult.materials.GetName(materialId));
+			}
+
+			const BlockList& layerBlocks{ layerResult.blocks };
+			for (size_t i{ 0 }; i < layerBlocks.GetCount(); ++i)
+			{
+				blocks.Add(layerBlocks.GetX(i), layerBlocks.GetY(i), layerBlocks.GetZ(i), materialIds[layerBlocks.GetMaterialId(i)], layerBlocks.IsOpaque(i));
+			}
+			warnings.Add(layerResult.warnings);
+
+			if (layer.positionRanges.empty()) continue;
+
+			//Positions of a split layer only count when the layer itself was valid
+			const bool isLayerValid{ layerResult.lastLayerMaterialId != EMPTY_MATERIAL };
+			for (size_t rangeIdx{ 0 }; rangeIdx < layer.positionRanges.size(); ++rangeIdx)
+			{
+				const ParseResult& positionsResult{ results[taskIdx++] };
+				if (isLayerValid == false) continue;
+
+				const std::vector<int>& positions{ positionsResult.positions };
+				for (size_t i{ 0 }; i < positions.size(); i += 3)
+				{
+					blocks.Add(positions[i], positions[i + 1], positions[i + 2], materialIds[layerResult.lastLayerMaterialId], layerResult.isLastLayerOpaque);
+				}
+				warnings.failedBlockCount += static_cast<size_t>(positionsResult.failedBlockCount);
+			}
+		}
+
+		return true;
+	}
+
+	//Reads the blocks of a scene file, a mapped file is parsed on the worker pool when it has more than one thread
+	//Warnings about skipped layers and blocks start the message, the conversion appends its own result to it
+	inline int ReadScene(const std::wstring& inputFilename, BlockList& blocks, MaterialRegistry& materials, std::wstring& message, const ConversionSettings& settings, ConversionStats& stats, WorkerPool& workerPool)
+	{
+		COMMONCODE_TRACE_SCOPE("ReadScene");
+
+		//Lists can be reused between files, they keep their memory
+		blocks.Clear();
+		materials.Clear();
+
+		//Map input file, fall back to a stream when it can't be mapped
+		MappedFile mappedFile{};
+		std::ifstream is{};
+		{
+			PhaseTimer timer{ stats, ConversionPhase::READ };
+			if (settings.inputMode == InputMode::MAPPED) mappedFile.Open(inputFilename);
+			if (mappedFile.IsOpen() == false) is.open(inputFilename);
+		}
+
+		if (mappedFile.IsOpen() || is.is_open())
+		{
+			//Read blocks while parsing
+			PhaseTimer timer{ stats, ConversionPhase::PARSE };
+			SceneWarnings warnings{};
+			bool isScene{ false };
+
+			if (mappedFile.IsOpen() && workerPool.GetThreadCount() > 1)
+			{
+				isScene = ParseSceneParallel(mappedFile.GetData(), mappedFile.GetSize(), blocks, materials, warnings, workerPool, settings.simdLevel);
+				stats.inputSize = mappedFile.GetSize();
+			}
+			else if (mappedFile.IsOpen())
+			{
+				ScanMemoryStream ms{ mappedFile.GetData(), mappedFile.GetSize(), settings.simdLevel };
+				isScene = ParseScene(ms, blocks, materials, warnings);
+				stats.inputSize = mappedFile.GetSize();
+			}
+			else
+			{
+				rapidjson::IStreamWrapper isw{ is };
+				isScene = ParseScene(isw, blocks, materials, warnings);
+				stats.inputSize = isw.Tell();
+			}
+
+			message = FormatSceneWarnings(warnings);
+			if (isScene)
+			{
+				stats.blockCount = blocks.GetCount();
+				stats.layerCount = materials.GetCount();
+				return 0;
+			}
+			else
+			{
+				blocks.Clear();
+				materials.Clear();
+				message += L"Failed to parse input file!\n";
+				return -1;
+			}
+		}
+		else
+		{
+			message = L"Couldn't find input file!\n";
+			return -1;
+		}
+	}
+
+	//Comment, material library, the 6 normals and the 4 unit texture coordinates every .obj output starts with
+	inline void WriteObjHeader(ObjWriter& writer)
+	{
+		//Initialize file with comment
+		writer.Write("#Minecraft Scene\n\n");
+
+		//Declare materials
+		writer.Write("mtllib Resources/minecraftMats.mtl\n\n");
+
+		//Add normals
+		writer.WriteNormal(0, 0, 1);
+		writer.WriteNormal(0, 0, -1);
+		writer.WriteNormal(0, 1, 0);
+		writer.WriteNormal(0, -1, 0);
+		writer.WriteNormal(1, 0, 0);
+		writer.WriteNormal(-1, 0, 0);
+
+		//Add texture coordinates
+		writer.WriteTexCoord(0, 0);
+		writer.WriteTexCoord(1, 0);
+		writer.WriteTexCoord(0, 1);
+		writer.WriteTexCoord(1, 1);
+	}
+
+	//writer is only used when the file isn't written in parallel, it keeps its buffer so it can be reused between files
+	inline int ConvertJsonToObj(const std::wstring& inputFilename, const std::wstring& outputFilename, BlockList& blocks, MaterialRegistry& materials, std::wstring& message, const ConversionSettings& settings, ConversionStats& stats, WorkerPool& workerPool, ObjWriter& writer)
+	{
+		COMMONCODE_TRACE_SCOPE("ConvertJsonToObj");
+
+		if (ReadScene(inputFilename, blocks, materials, message, settings, stats, workerPool) == -1) return -1;
+
+		ObjWriter header{ 4096 };
+		WriteObjHeader(header);
+
+		//Cull hidden faces
+		VoxelGrid grid{ blocks.GetCount() };
+		BuildVoxelGrid(blocks, grid, workerPool, stats, settings.simdLevel);
+
+		if (settings.meshMode == MeshMode::BLOCKS && settings.weldVertices == false && workerPool.GetThreadCount() > 1)
+		{
+			std::vector<uint8_t> visibleFaces{};
+			{
+				PhaseTimer timer{ stats, ConversionPhase::CULL };
+				visibleFaces = GetVisibleBlockFaces(blocks, grid, workerPool);
+			}
+			const size_t visibleFaceCount{ CountVisibleFaces(visibleFaces) };
+			stats.SetFaceCounts(visibleFaceCount, visibleFaceCount);
+			header.Write("\n");
+
+			//Size the file up front so every range of blocks is written straight to its place
+			BlockMeshLayout layout{};
+			{
+				PhaseTimer timer{ stats, ConversionPhase::MESH };
+				layout = BuildBlockMeshLayout(header.GetSize(), blocks, visibleFaces, materials, workerPool);
+			}
+
+			MappedOutputFile outputFile{};
+			{
+				PhaseTimer timer{ stats, ConversionPhase::FLUSH };
+				if (outputFile.Create(outputFilename, layout.fileSize) == false)
+				{
+					message += L"Failed to create output file!\n";
+					return -1;
+				}
+			}
+
+			memcpy(outputFile.GetData(), header.GetData(), header.GetSize());
+			const bool isWritten{ WriteBlockMesh(outputFile.GetData(), layout, blocks, visibleFaces, materials, workerPool, stats) };
+
+			PhaseTimer timer{ stats, ConversionPhase::FLUSH };
+			if (outputFile.Close() == false || isWritten == false)
+			{
+				message += L"Failed to write output file!\n";
+				return -1;
+			}
+			stats.outputSize = layout.fileSize;
+		}
+		else
+		{
+			{
+				PhaseTimer timer{ stats, ConversionPhase::FLUSH };
+				if (writer.Open(outputFilename) == false)
+				{
+					message += L"Failed to create output file!\n";
+					return -1;
+				}
+			}
+
+			writer.Write(header);
+
+			if (settings.meshMode == MeshMode::GREEDY)
+			{
+				//Add merged faces
+				std::vector<MeshQuad> quads{};
+				{
+					PhaseTimer timer{ stats, ConversionPhase::MESH };
+					quads = BuildGreedyQuads(grid, workerPool);
+				}
+				stats.SetFaceCounts(CountQuadFaces(quads), quads.size());
+
+				WriteQuadMesh(writer, quads, materials.GetNames(), settings.weldVertices, stats);
+			}
+			else if (settings.weldVertices)
+			{
+				//Add faces with shared vertices
+				std::vector<MeshQuad> quads{};
+				{
+					PhaseTimer timer{ stats, ConversionPhase::CULL };
+					quads = BuildBlockQuads(blocks, GetVisibleBlockFaces(blocks, grid, workerPool));
+				}
+				stats.SetFaceCounts(quads.size(), quads.size());
+
+				WriteQuadMesh(writer, quads, materials.GetNames(), true, stats);
+			}
+			else
+			{
+				std::vector<uint8_t> visibleFaces{};
+				{
+					PhaseTimer timer{ stats, ConversionPhase::CULL };
+					visibleFaces = GetVisibleBlockFaces(blocks, grid, workerPool);
+				}
+				const size_t visibleFaceCount{ CountVisibleFaces(visibleFaces) };
+				stats.SetFaceCounts(visibleFaceCount, visibleFaceCount);
+
+				writer.Write("\n");
+
+				//Add vertices of blocks that are not fully hidden
+				{
+					PhaseTimer timer{ stats, ConversionPhase::VERTEX_WRITE };
+					WriteBlockVertices(writer, blocks, visibleFaces, 0, blocks.GetCount());
+				}
+
+				//Add faces
+				PhaseTimer timer{ stats, ConversionPhase::FACE_WRITE };
+				WriteFaces(writer, blocks, visibleFaces, materials, 0, blocks.GetCount(), 0, EMPTY_MATERIAL);
+			}
+
+			PhaseTimer timer{ stats, ConversionPhase::FLUSH };
+			if (writer.Close() == false)
+			{
+				message += L"Failed to write output file!\n";
+				return -1;
+			}
+			stats.outputSize = writer.GetWrittenSize();
+		}
+
+		message += L"Output file was succesfully created!\n";
+		return 0;
+	}
+
+	inline int ConvertJsonToObj(const std::wstring& inputFilename, const std::wstring& outputFilename, BlockList& blocks, MaterialRegistry& materials, std::wstring& message, const ConversionSettings& settings, ConversionStats& stats, WorkerPool& workerPool)
+	{
+		ObjWriter writer{};
+		return ConvertJsonToObj(inputFilename, outputFilename, blocks, materials, message, settings, stats, workerPool, writer);
+	}
+
+	inline int ConvertJsonToObj(const std::wstring& inputFilename, const std::wstring& outputFilename, BlockList& blocks, MaterialRegistry& materials, std::wstring& message, const ConversionSettings& settings = ConversionSettings{})
+	{
+		ConversionStats stats{};
+		WorkerPool workerPool{ settings.threadCount };
+		return ConvertJsonToObj(inputFilename, outputFilename, blocks, materials, message, settings, stats, workerPool);
+	}
+
+	//Scene kept in memory between updates of a watched input file
+	struct WatchedScene
+	{
+		BlockList blocks{};
+		MaterialRegistry fileMaterials{}; //materials of the last read, ids change with the order of the layers
+		MaterialRegistry materials{}; //every material seen since watching started, the cached meshes use these ids
+		ChunkMeshCache meshes{};
+	};
+
+	struct WatchStats
+	{
+		size_t chunkCount{ 0 };
+		size_t meshedChunkCount{ 0 };
+		double updateTime{ 0.0 }; //seconds
+	};
+
+	//Reads the changed input file and rewrites the .obj output, only the chunks that changed and their neighbours are meshed again
+	//Greedy mode merges faces within a chunk only, vertices are never welded
+	//When the input can't be read the scene is left as it was, so the next write is compared against the last good one
+	//The worker pool is kept by the caller, so its threads aren't started again on every change
+	inline int UpdateWatchedObj(const std::wstring& inputFilename, const std::wstring& outputFilename, WatchedScene& scene, std::wstring& message, const ConversionSettings& settings, ConversionStats& stats, WatchStats& watchStats, WorkerPool& workerPool)
+	{
+		COMMONCODE_TRACE_SCOPE("UpdateWatchedObj");
+
+		const std::chrono::steady_clock::time_point updateStart{ std::chrono::steady_clock::now() };
+
+		if (ReadScene(inputFilename, scene.blocks, scene.fileMaterials, message, settings, stats, workerPool) == -1) return -1;
+
+		//Material ids of this read to the ids of the session
+		std::vector<uint16_t> materialIds(scene.fileMaterials.GetCount());
+		for (size_t i{ 0 }; i < materialIds.size(); ++i)
+		{
+			materialIds[i] = scene.materials.GetMaterialId(scene.fileMaterials.GetName(static_cast<uint16_t>(i)));
+		}
+
+		const BlockList& blocks{ scene.blocks };
+		VoxelGrid grid{ blocks.GetCount() };
+		for (size_t i{ 0 }; i < blocks.GetCount(); ++i)
+		{
+			grid.SetBlock(blocks.GetX(i), blocks.GetY(i), blocks.GetZ(i), blocks.IsOpaque(i), materialIds[blocks.GetMaterialId(i)]);
+		}
+
+		watchStats.meshedChunkCount = scene.meshes.Update(std::move(grid), settings.meshMode == MeshMode::GREEDY, workerPool, settings.simdLevel);
+		watchStats.chunkCount = scene.meshes.GetChunkCount();
+
+		ObjWriter writer{};
+		if (writer.Open(outputFilename) == false)
+		{
+			message += L"Failed to create output file!\n";
+			return -1;
+		}
+
+		WriteObjHeader(writer);
+		writer.Write("\n");
+		scene.meshes.Write(writer, scene.materials.GetNames());
+
+		if (writer.Close() == false)
+		{
+			message += L"Failed to write output file!\n";
+			return -1;
+		}
+
+		watchStats.updateTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - updateStart).count();
+
+		message += L"Output file was succesfully updated!\n";
+		return 0;
+	}
+
+	//Culls hidden faces and returns the visible ones as quads, merged in greedy mode
+	inline std::vector<MeshQuad> BuildSceneQuads(const BlockList& blocks, const ConversionSettings& settings, WorkerPool& workerPool, ConversionStats& stats)
+	{
+		VoxelGrid grid{ blocks.GetCount() };
+		BuildVoxelGrid(blocks, grid, workerPool, stats, settings.simdLevel);
+
+		std::vector<MeshQuad> quads{};
+		if (settings.meshMode == MeshMode::GREEDY)
+		{
+			PhaseTimer timer{ stats, ConversionPhase::MESH };
+			quads = BuildGreedyQuads(grid, workerPool);
+		}
+		else
+		{
+			PhaseTimer timer{ stats, ConversionPhase::CULL };
+			quads = BuildBlockQuads(blocks, GetVisibleBlockFaces(blocks, grid, workerPool));
+		}
+
+		stats.SetFaceCounts(CountQuadFaces(quads), quads.size());
+		return quads;
+	}
+
+	//A layer is instanced when it has at least this many quads per block with visible faces
+	//Without merging that leaves at most 2 neighbours per block, so drawing whole cubes costs at most 1.5 times the triangles of the quads
+	//while the file stores 12 bytes per block instead of 4 vertices and 6 indices per quad
+	constexpr size_t INSTANCE_MIN_QUADS_PER_BLOCK{ 4 };
+
+	//Picks the layers that are sparse enough to be drawn as instanced cubes and collects their blocks with visible faces
+	//Quads are counted instead of visible faces so greedy mode only instances layers that merging doesn't reduce
+	inline std::vector<GlbInstanceGroup> BuildInstanceGroups(const BlockList& blocks, const std::vector<uint8_t>& blockFaces, const std::vector<MeshQuad>& quads, const size_t materialCount)
+	{
+		std::vector<size_t> shownBlockCounts(materialCount, 0);
+		for (size_t i{ 0 }; i < blocks.GetCount(); ++i)
+		{
+			if (blockFaces[i] != 0) ++shownBlockCounts[blocks.GetMaterialId(i)];
+		}
+
+		std::vector<size_t> quadCounts(materialCount, 0);
+		for (const MeshQuad& quad : quads) ++quadCounts[quad.materialId];
+
+		std::vector<int> groupIndices(materialCount, -1);
+		std::vector<GlbInstanceGroup> instanceGroups{};
+		for (size_t materialId{ 0 }; materialId < materialCount; ++materialId)
+		{
+			if (shownBlockCounts[materialId] == 0 || quadCounts[materialId] < shownBlockCounts[materialId] * INSTANCE_MIN_QUADS_PER_BLOCK) continue;
+
+			groupIndices[materialId] = static_cast<int>(instanceGroups.size());
+			instanceGroups.push_back(GlbInstanceGroup{ static_cast<uint16_t>(materialId), {} });
+			instanceGroups.back().translations.reserve(shownBlockCounts[materialId] * 3);
+		}
+
+		for (size_t i{ 0 }; i < blocks.GetCount() && instanceGroups.empty() == false; ++i)
+		{
+			const int groupIdx{ groupIndices[blocks.GetMaterialId(i)] };
+			if (blockFaces[i] == 0 || groupIdx == -1) continue;
+
+			std::vector<float>& translations{ instanceGroups[groupIdx].translations };
+			translations.push_back(static_cast<float>(blocks.GetX(i)));
+			translations.push_back(static_cast<float>(blocks.GetY(i)));
+			translations.push_back(static_cast<float>(blocks.GetZ(i)));
+		}
+
+		return instanceGroups;
+	}
+
+	//Writes the culled or greedy quads of the scene as binary glTF, one primitive per material
+	//Sparse layers are written as instances of a unit cube instead, unless instancing is turned off
+	//Materials come from the same Resources/minecraftMats.mtl the .obj output refers to, looked up next to the output file
+	inline int ConvertJsonToGlb(const std::wstring& inputFilename, const std::wstring& outputFilename, BlockList& blocks, MaterialRegistry& materials, std::wstring& message, const ConversionSettings& settings, ConversionStats& stats, WorkerPool& workerPool)
+	{
+		COMMONCODE_TRACE_SCOPE("ConvertJsonToGlb");
+
+		if (ReadScene(inputFilename, blocks, materials, message, settings, stats, workerPool) == -1) return -1;
+
+		//Cull hidden faces
+		VoxelGrid grid{ blocks.GetCount() };
+		BuildVoxelGrid(blocks, grid, workerPool, stats, settings.simdLevel);
+
+		std::vector<uint8_t> visibleFaces{};
+		{
+			PhaseTimer timer{ stats, ConversionPhase::CULL };
+			visibleFaces = GetVisibleBlockFaces(blocks, grid, workerPool);
+		}
+
+		PhaseTimer meshTimer{ stats, ConversionPhase::MESH };
+		std::vector<MeshQuad> quads{ (settings.meshMode == MeshMode::GREEDY) ? BuildGreedyQuads(grid, workerPool) : BuildBlockQuads(blocks, visibleFaces) };
+		const size_t visibleFaceCount{ CountQuadFaces(quads) };
+
+		std::vector<GlbInstanceGroup> instanceGroups{};
+		if (settings.instanceMode == InstanceMode::AUTO)
+		{
+			instanceGroups = BuildInstanceGroups(blocks, visibleFaces, quads, materials.GetCount());
+		}
+
+		//Instanced layers don't need their faces
+		if (instanceGroups.empty() == false)
+		{
+			std::vector<bool> isInstanced(materials.GetCount(), false);
+			for (const GlbInstanceGroup& instanceGroup : instanceGroups) isInstanced[instanceGroup.materialId] = true;
+
+			quads.erase(std::remove_if(quads.begin(), quads.end(), [&isInstanced](const MeshQuad& quad) { return isInstanced[quad.materialId]; }), quads.end());
+		}
+
+		const size_t lastSlashIdx{ outputFilename.find_last_of(L"\\/") };
+		const std::wstring outputLocation{ outputFilename.substr(0, (lastSlashIdx != std::wstring::npos) ? lastSlashIdx + 1 : 0) };
+		const GlbLayout layout{ BuildGlbLayout(quads, instanceGroups, materials.GetNames(), ReadMtlFile(outputLocation + L"Resources/minecraftMats.mtl")) };
+		meshTimer.Stop();
+
+		//Instanced cubes draw all of their faces
+		size_t instanceCount{ 0 };
+		for (const GlbInstanceGroup& instanceGroup : instanceGroups) instanceCount += instanceGroup.translations.size() / 3;
+		stats.SetFaceCounts(visibleFaceCount, quads.size() + instanceCount * NEIGHBOUR_COUNT);
+
+		if (layout.fileSize > UINT32_MAX)
+		{
+			message += L"Scene is too large for a .glb file!\n";
+			return -1;
+		}
+
+		MappedOutputFile outputFile{};
+		{
+			PhaseTimer timer{ stats, ConversionPhase::FLUSH };
+			if (outputFile.Create(outputFilename, layout.fileSize) == false)
+			{
+				message += L"Failed to create output file!\n";
+				return -1;
+			}
+		}
+
+		{
+			PhaseTimer timer{ stats, ConversionPhase::VERTEX_WRITE };
+			WriteGlb(outputFile.GetData(), layout, quads, instanceGroups, workerPool);
+		}
+
+		PhaseTimer timer{ stats, ConversionPhase::FLUSH };
+		if (outputFile.Close() == false)
+		{
+			message += L"Failed to write output file!\n";
+			return -1;
+		}
+		stats.outputSize = layout.fileSize;
+
+		message += L"Output file was succesfully created!\n";
+		return 0;
+	}
+
+	//Writes the culled or greedy quads of the scene as binary PLY, with normals, texture coordinates and a material per face
+	inline int ConvertJsonToPly(const std::wstring& inputFilename, const std::wstring& outputFilename, BlockList& blocks, MaterialRegistry& materials, std::wstring& message, const ConversionSettings& settings, ConversionStats& stats, WorkerPool& workerPool)
+	{
+		COMMONCODE_TRACE_SCOPE("ConvertJsonToPly");
+
+		if (ReadScene(inputFilename, blocks, materials, message, settings, stats, workerPool) == -1) return -1;
+
+		const std::vector<MeshQuad> quads{ BuildSceneQuads(blocks, settings, workerPool, stats) };
+
+		if (quads.size() * 4 > UINT32_MAX)
+		{
+			message += L"Scene is too large for a .ply file!\n";
+			return -1;
+		}
+
+		const std::string header{ BuildPlyHeader(quads.size(), materials.GetNames()) };
+
+		MappedOutputFile outputFile{};
+		{
+			PhaseTimer timer{ stats, ConversionPhase::FLUSH };
+			if (outputFile.Create(outputFilename, GetPlyFileSize(header, quads.size())) == false)
+			{
+				message += L"Failed to create output file!\n";
+				return -1;
+			}
+		}
+
+		{
+			PhaseTimer timer{ stats, ConversionPhase::VERTEX_WRITE };
+			WritePly(outputFile.GetData(), header, quads, workerPool);
+		}
+
+		PhaseTimer timer{ stats, ConversionPhase::FLUSH };
+		if (outputFile.Close() == false)
+		{
+			message += L"Failed to write output file!\n";
+			return -1;
+		}
+		stats.outputSize = GetPlyFileSize(header, quads.size());
+
+		message += L"Output file was succesfully created!\n";
+		return 0;
+	}
+
+	//Writes the culled or greedy quads of the scene as binary STL, 2 triangles per quad
+	inline int ConvertJsonToStl(const std::wstring& inputFilename, const std::wstring& outputFilename, BlockList& blocks, MaterialRegistry& materials, std::wstring& message, const ConversionSettings& settings, ConversionStats& stats, WorkerPool& workerPool)
+	{
+		COMMONCODE_TRACE_SCOPE("ConvertJsonToStl");
+
+		if (ReadScene(inputFilename, blocks, materials, message, settings, stats, workerPool) == -1) return -1;
+
+		const std::vector<MeshQuad> quads{ BuildSceneQuads(blocks, settings, workerPool, stats) };
+
+		if (quads.size() * 2 > UINT32_MAX)
+		{
+			message += L"Scene is too large for a .stl file!\n";
+			return -1;
+		}
+
+		MappedOutputFile outputFile{};
+		{
+			PhaseTimer timer{ stats, ConversionPhase::FLUSH };
+			if (outputFile.Create(outputFilename, GetStlFileSize(quads.size())) == false)
+			{
+				message += L"Failed to create output file!\n";
+				return -1;
+			}
+		}
+
+		{
+			PhaseTimer timer{ stats, ConversionPhase::VERTEX_WRITE };
+			WriteStl(outputFile.GetData(), quads, workerPool);
+		}
+
+		PhaseTimer timer{ stats, ConversionPhase::FLUSH };
+		if (outputFile.Close() == false)
+		{
+			message += L"Failed to write output file!\n";
+			return -1;
+		}
+		stats.outputSize = GetStlFileSize(quads.size());
+
+		message += L"Output file was succesfully created!\n";
+		return 0;
+	}
+
+	enum class OutputFormat
+	{
+		OBJ,
+		GLB,
+		PLY,
+		STL,
+	};
+
+	inline bool HasExtension(const std::wstring& filename, const std::wstring& extension)
+	{
+		return filename.size() > extension.size() && filename.compare(filename.size() - extension.size(), extension.size(), extension) == 0;
+	}
+
+	//Picks the format from the extension of the output file, anything unknown is written as .obj
+	inline OutputFormat GetOutputFormat(const std::wstring& outputFilename)
+	{
+		if (HasExtension(outputFilename, L".glb")) return OutputFormat::GLB;
+		if (HasExtension(outputFilename, L".ply")) return OutputFormat::PLY;
+		if (HasExtension(outputFilename, L".stl")) return OutputFormat::STL;
+		return OutputFormat::OBJ;
+	}
+
+	//Converts to the format of the output file extension, writer is only used for .obj output
+	inline int ConvertJsonToMesh(const std::wstring& inputFilename, const std::wstring& outputFilename, BlockList& blocks, MaterialRegistry& materials, std::wstring& message, const ConversionSettings& settings, ConversionStats& stats, WorkerPool& workerPool, ObjWriter& writer)
+	{
+		int result{ -1 };
+		switch (GetOutputFormat(outputFilename))
+		{
+		case OutputFormat::GLB: result = ConvertJsonToGlb(inputFilename, outputFilename, blocks, materials, message, settings, stats, workerPool); break;
+		case OutputFormat::PLY: result = ConvertJsonToPly(inputFilename, outputFilename, blocks, materials, message, settings, stats, workerPool); break;
+		case OutputFormat::STL: result = ConvertJsonToStl(inputFilename, outputFilename, blocks, materials, message, settings, stats, workerPool); break;
+		case OutputFormat::OBJ:
+		default: result = ConvertJsonToObj(inputFilename, outputFilename, blocks, materials, message, settings, stats, workerPool, writer); break;
+		}
+
+		stats.peakMemoryUsage = GetPeakMemoryUsage();
+		return result;
+	}
+
+	inline int ConvertJsonToMesh(const std::wstring& inputFilename, const std::wstring& outputFilename, BlockList& blocks, MaterialRegistry& materials, std::wstring& message, const ConversionSettings& settings, ConversionStats& stats, WorkerPool& workerPool)
+	{
+		ObjWriter writer{};
+		return ConvertJsonToMesh(inputFilename, outputFilename, blocks, materials, message, settings, stats, workerPool, writer);
+	}
+
+	inline int ConvertJsonToMesh(const std::wstring& inputFilename, const std::wstring& outputFilename, BlockList& blocks, MaterialRegistry& materials, std::wstring& message, const ConversionSettings& settings, ConversionStats& stats)
+	{
+		WorkerPool workerPool{ settings.threadCount };
+		return ConvertJsonToMesh(inputFilename, outputFilename, blocks, materials, message, settings, stats, workerPool);
+	}
+
+	//Input and output file of one conversion in a batch
+	struct BatchJob
+	{
+		std::wstring inputFilename;
+		std::wstring outputFilename;
+	};
+
+	struct BatchStats
+	{
+		size_t fileCount{ 0 };
+		size_t failedCount{ 0 };
+		size_t blockCount{ 0 };
+		size_t inputSize{ 0 }; //bytes
+		double time{ 0.0 }; //seconds
+
+		double GetFileThroughput() const //files/s
+		{
+			return (time > 0.0) ? static_cast<double>(fileCount) / time : 0.0;
+		}
+
+		double GetBlockThroughput() const //blocks/s
+		{
+			return (time > 0.0) ? static_cast<double>(blockCount) / time : 0.0;
+		}
+
+		double GetInputThroughput() const //MB/s
+		{
+			return (time > 0.0) ? static_cast<double>(inputSize) / 1000000.0 / time : 0.0;
+		}
+	};
+
+	//Converts the jobs concurrently on settings.threadCount threads, every thread converts whole files one at a time
+	//Each thread keeps its block list, materials, single-threaded pool and writer between files, so their memory is only allocated for the largest file
+	//messages gets the message of every job, in job order
+	inline void ConvertBatch(const std::vector<BatchJob>& jobs, const ConversionSettings& settings, std::vector<std::wstring>& messages, BatchStats& stats)
+	{
+		const std::chrono::steady_clock::time_point batchStart{ std::chrono::steady_clock::now() };
+
+		ConversionSettings fileSettings{ settings };
+		fileSettings.threadCount = 1;
+
+		WorkerPool workerPool{ static_cast<int>((std::min)(static_cast<size_t>(settings.threadCount), (std::max)(jobs.size(), size_t{ 1 }))) };
+		std::vector<BlockList> threadBlocks(workerPool.GetThreadCount());
+		std::vector<MaterialRegistry> threadMaterials(workerPool.GetThreadCount());
+		std::vector<WorkerPool> threadPools(workerPool.GetThreadCount()); //one thread each, files run on the thread of the batch
+		std::vector<ObjWriter> threadWriters(workerPool.GetThreadCount());
+
+		std::vector<int> results(jobs.size(), -1);
+		std::vector<size_t> blockCounts(jobs.size(), 0);
+		std::vector<size_t> inputSizes(jobs.size(), 0);
+		messages.assign(jobs.size(), L"");
+
+		workerPool.ParallelFor(jobs.size(), 1,
+			[&](const size_t begin, const size_t end, const int threadIdx)
+			{
+				for (size_t jobIdx{ begin }; jobIdx < end; ++jobIdx)
+				{
+					COMMONCODE_TRACE_SCOPE("convert file", "job", static_cast<int64_t>(jobIdx));
+					BlockList& blocks{ threadBlocks[threadIdx] };
+					ConversionStats fileStats{};
+					results[jobIdx] = ConvertJsonToMesh(
+						jobs[jobIdx].inputFilename, jobs[jobIdx].outputFilename, blocks, threadMaterials[threadIdx], messages[jobIdx], fileSettings, fileStats, threadPools[threadIdx], threadWriters[threadIdx]
+					);
+					blockCounts[jobIdx] = blocks.GetCount();
+					inputSizes[jobIdx] = fileStats.inputSize;
+				}
+			}
+		);
+
+		stats = BatchStats{};
+		for (size_t jobIdx{ 0 }; jobIdx < jobs.size(); ++jobIdx)
+		{
+			if (results[jobIdx] == -1)
+			{
+				++stats.failedCount;
+				continue;
+			}
+
+			++stats.fileCount;
+			stats.blockCount += blockCounts[jobIdx];
+			stats.inputSize += inputSizes[jobIdx];
+		}
+
+		stats.time = std::chrono::duration<double>(std::chrono::steady_clock::now() - batchStart).count();
 	}
 }
@@ -0,0 +1,251 @@
+#pragma once
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <chrono>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+#include "VoxelGrid.h"
+#include "ObjWriter.h"
+#include "ConversionTrace.h"
+
+namespace commonCode
+{
+	//Steps of a conversion, in the order they run
+	enum class ConversionPhase
+	{
+		READ, //opening or mapping the input, mapped pages are read while parsing
+		PARSE,
+		BLOCK_BUILD, //filling the voxel grid
+		CULL, //hidden faces of the grid and visible faces of every block
+		MESH, //merging faces into quads and sizing the output
+		VERTEX_WRITE, //formatting vertices, binary formats fill vertices and faces in this one pass
+		FACE_WRITE,
+		FLUSH, //creating, flushing and closing the output file
+		COUNT,
+	};
+
+	constexpr size_t CONVERSION_PHASE_COUNT{ static_cast<size_t>(ConversionPhase::COUNT) };
+
+	inline const wchar_t* ToString(const ConversionPhase phase)
+	{
+		switch (phase)
+		{
+		case ConversionPhase::READ: return L"read";
+		case ConversionPhase::PARSE: return L"parse";
+		case ConversionPhase::BLOCK_BUILD: return L"block build";
+		case ConversionPhase::CULL: return L"cull";
+		case ConversionPhase::MESH: return L"mesh";
+		case ConversionPhase::VERTEX_WRITE: return L"vertex write";
+		case ConversionPhase::FACE_WRITE: return L"face write";
+		case ConversionPhase::FLUSH: return L"flush";
+		case ConversionPhase::COUNT:
+		default: return L"";
+		}
+	}
+
+	//CPU time of all threads of the process in seconds
+	inline double GetProcessCpuTime()
+	{
+#if defined(_WIN32)
+		FILETIME creationTime{};
+		FILETIME exitTime{};
+		FILETIME kernelTime{};
+		FILETIME userTime{};
+		if (GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime) == FALSE) return 0.0;
+
+		const uint64_t kernelTicks{ (static_cast<uint64_t>(kernelTime.dwHighDateTime) << 32) | kernelTime.dwLowDateTime };
+		const uint64_t userTicks{ (static_cast<uint64_t>(userTime.dwHighDateTime) << 32) | userTime.dwLowDateTime };
+		return static_cast<double>(kernelTicks + userTicks) / 10000000.0; //100 ns ticks
+#else
+		rusage usage{};
+		if (getrusage(RUSAGE_SELF, &usage) != 0) return 0.0;
+
+		return static_cast<double>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec)
+			+ static_cast<double>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000000.0;
+#endif
+	}
+
+	//Largest resident set (working set on Windows) the process had so far, in bytes
+	inline size_t GetPeakMemoryUsage()
+	{
+#if defined(_WIN32)
+		PROCESS_MEMORY_COUNTERS counters{};
+		if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) == FALSE) return 0;
+
+		return counters.PeakWorkingSetSize;
+#else
+		rusage usage{};
+		if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+
+#if defined(__APPLE__)
+		return static_cast<size_t>(usage.ru_maxrss); //bytes
+#else
+		return static_cast<size_t>(usage.ru_maxrss) * 1024; //kilobytes
+#endif
+#endif
+	}
+
+	struct PhaseTime
+	{
+		double wallTime; //seconds
+		double cpuTime; //seconds of all threads, above wallTime when the phase ran in parallel
+	};
+
+	struct ConversionStats
+	{
+		size_t inputSize{ 0 }; //bytes
+		PhaseTime phaseTimes[CONVERSION_PHASE_COUNT]{};
+
+		size_t blockCount{ 0 };
+		size_t layerCount{ 0 };
+		size_t emittedFaceCount{ 0 }; //faces in the output, merged quads count once
+		size_t culledFaceCount{ 0 }; //block faces hidden by a neighbour
+		size_t outputSize{ 0 }; //bytes
+		size_t peakMemoryUsage{ 0 }; //bytes
+
+		const PhaseTime& GetPhaseTime(const ConversionPhase phase) const { return phaseTimes[static_cast<size_t>(phase)]; }
+
+		double GetParseThroughput() const //MB/s
+		{
+			const double parseTime{ GetPhaseTime(ConversionPhase::PARSE).wallTime };
+			return (parseTime > 0.0) ? static_cast<double>(inputSize) / 1000000.0 / parseTime : 0.0;
+		}
+
+		//Culled faces are the block faces that aren't visible, visibleFaceCount counts faces before they are merged
+		void SetFaceCounts(const size_t visibleFaceCount, const size_t emittedCount)
+		{
+			emittedFaceCount = emittedCount;
+			culledFaceCount = (blockCount * NEIGHBOUR_COUNT > visibleFaceCount) ? blockCount * NEIGHBOUR_COUNT - visibleFaceCount : 0;
+		}
+	};
+
+#if defined(COMMONCODE_TRACE)
+	//Span names have to be string literals
+	inline const char* GetTraceName(const ConversionPhase phase)
+	{
+		switch (phase)
+		{
+		case ConversionPhase::READ: return "read";
+		case ConversionPhase::PARSE: return "parse";
+		case ConversionPhase::BLOCK_BUILD: return "block build";
+		case ConversionPhase::CULL: return "cull";
+		case ConversionPhase::MESH: return "mesh";
+		case ConversionPhase::VERTEX_WRITE: return "vertex write";
+		case ConversionPhase::FACE_WRITE: return "face write";
+		case ConversionPhase::FLUSH: return "flush";
+		case ConversionPhase::COUNT:
+		default: return "";
+		}
+	}
+#endif
+
+	//Adds the wall and CPU time from its construction to its destruction, or to Stop, to a phase
+	//Every phase is also a span of the trace
+	class PhaseTimer
+	{
+	public:
+		PhaseTimer(ConversionStats& stats, const ConversionPhase phase)
+			: m_PhaseTime{ stats.phaseTimes[static_cast<size_t>(phase)] }
+			, m_WallStart{ std::chrono::steady_clock::now() }
+			, m_CpuStart{ GetProcessCpuTime() }
+#if defined(COMMONCODE_TRACE)
+			, m_TraceScope{ GetTraceName(phase) }
+#endif
+		{
+		}
+
+		~PhaseTimer()
+		{
+			Stop();
+		}
+
+		PhaseTimer(const PhaseTimer&) = delete;
+		PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+		//Ends the phase before the timer goes out of scope, later calls do nothing
+		void Stop()
+		{
+			if (m_IsStopped) return;
+
+			m_PhaseTime.wallTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - m_WallStart).count();
+			m_PhaseTime.cpuTime += GetProcessCpuTime() - m_CpuStart;
+			m_IsStopped = true;
+#if defined(COMMONCODE_TRACE)
+			m_TraceScope.End();
+#endif
+		}
+
+	private:
+		PhaseTime& m_PhaseTime;
+		const std::chrono::steady_clock::time_point m_WallStart;
+		const double m_CpuStart;
+		bool m_IsStopped{ false };
+#if defined(COMMONCODE_TRACE)
+		TraceScope m_TraceScope;
+#endif
+	};
+
+	//One JSON object per conversion, phase names have their spaces replaced so they can be used as keys
+	inline std::string FormatStatsJson(const ConversionStats& stats, const std::wstring& inputFilename, const std::wstring& outputFilename)
+	{
+		rapidjson::StringBuffer buffer{};
+		rapidjson::Writer<rapidjson::StringBuffer> writer{ buffer };
+
+		writer.StartObject();
+		writer.Key("input");
+		writer.String(ToUtf8(inputFilename).c_str());
+		writer.Key("output");
+		writer.String(ToUtf8(outputFilename).c_str());
+
+		writer.Key("phases");
+		writer.StartObject();
+		for (size_t phaseIdx{ 0 }; phaseIdx < CONVERSION_PHASE_COUNT; ++phaseIdx)
+		{
+			std::string phaseName{ ToUtf8(ToString(static_cast<ConversionPhase>(phaseIdx))) };
+			for (char& c : phaseName)
+			{
+				if (c == ' ') c = '_';
+			}
+
+			writer.Key(phaseName.c_str());
+			writer.StartObject();
+			writer.Key("wall");
+			writer.Double(stats.phaseTimes[phaseIdx].wallTime);
+			writer.Key("cpu");
+			writer.Double(stats.phaseTimes[phaseIdx].cpuTime);
+			writer.EndObject();
+		}
+		writer.EndObject();
+
+		writer.Key("blocks");
+		writer.Uint64(stats.blockCount);
+		writer.Key("layers");
+		writer.Uint64(stats.layerCount);
+		writer.Key("facesEmitted");
+		writer.Uint64(stats.emittedFaceCount);
+		writer.Key("facesCulled");
+		writer.Uint64(stats.culledFaceCount);
+		writer.Key("bytesRead");
+		writer.Uint64(stats.inputSize);
+		writer.Key("bytesWritten");
+		writer.Uint64(stats.outputSize);
+		writer.Key("peakRss");
+		writer.Uint64(stats.peakMemoryUsage);
+		writer.EndObject();
+
+		return std::string{ buffer.GetString(), buffer.GetSize() };
+	}
+}
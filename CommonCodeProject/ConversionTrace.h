@@ -0,0 +1,234 @@
+#pragma once
+
+//Scoped spans of a conversion in the Chrome trace event format, they open in chrome://tracing and Perfetto
+//The spans are only compiled in when COMMONCODE_TRACE is defined, otherwise the macros below are empty
+#if defined(COMMONCODE_TRACE)
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+#include "ObjWriter.h"
+
+namespace commonCode
+{
+	struct TraceEvent
+	{
+		const char* name; //has to outlive the recording, spans are named with string literals
+		std::chrono::steady_clock::time_point start;
+		std::chrono::steady_clock::duration duration;
+		const char* argNames[2]; //nullptr --> no argument
+		int64_t argValues[2];
+	};
+
+	//Collects the spans of every thread, each thread appends to a buffer of its own so spans don't wait on each other
+	class TraceRecorder
+	{
+	public:
+		static TraceRecorder& GetInstance()
+		{
+			static TraceRecorder recorder{};
+			return recorder;
+		}
+
+		TraceRecorder(const TraceRecorder&) = delete;
+		TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+		//Drops the spans of an earlier recording, no other thread may be running spans
+		void Start()
+		{
+			{
+				std::lock_guard<std::mutex> lock{ m_Mutex };
+				for (const std::unique_ptr<ThreadBuffer>& pBuffer : m_Buffers) pBuffer->events.clear();
+			}
+
+			ThreadBuffer& buffer{ GetThreadBuffer() };
+			if (buffer.name.empty()) buffer.name = "main";
+
+			m_Start = std::chrono::steady_clock::now();
+			m_IsRecording = true;
+		}
+
+		//Writes the spans recorded since Start, every thread that recorded spans has to be done with them
+		bool Stop(const std::wstring& filename)
+		{
+			m_IsRecording = false;
+
+			rapidjson::StringBuffer stringBuffer{};
+			rapidjson::Writer<rapidjson::StringBuffer> writer{ stringBuffer };
+
+			writer.StartObject();
+			writer.Key("traceEvents");
+			writer.StartArray();
+			{
+				std::lock_guard<std::mutex> lock{ m_Mutex };
+				for (const std::unique_ptr<ThreadBuffer>& pBuffer : m_Buffers)
+				{
+					if (pBuffer->events.empty()) continue;
+
+					//Name the thread
+					const std::string threadName{ pBuffer->name.empty() ? "thread " + std::to_string(pBuffer->threadId) : pBuffer->name };
+					writer.StartObject();
+					writer.Key("name");
+					writer.String("thread_name");
+					writer.Key("ph");
+					writer.String("M");
+					writer.Key("pid");
+					writer.Int(1);
+					writer.Key("tid");
+					writer.Uint(pBuffer->threadId);
+					writer.Key("args");
+					writer.StartObject();
+					writer.Key("name");
+					writer.String(threadName.c_str());
+					writer.EndObject();
+					writer.EndObject();
+
+					//Complete events, times are in microseconds
+					for (const TraceEvent& event : pBuffer->events)
+					{
+						writer.StartObject();
+						writer.Key("name");
+						writer.String(event.name);
+						writer.Key("cat");
+						writer.String("conversion");
+						writer.Key("ph");
+						writer.String("X");
+						writer.Key("ts");
+						writer.Double(std::chrono::duration<double, std::micro>(event.start - m_Start).count());
+						writer.Key("dur");
+						writer.Double(std::chrono::duration<double, std::micro>(event.duration).count());
+						writer.Key("pid");
+						writer.Int(1);
+						writer.Key("tid");
+						writer.Uint(pBuffer->threadId);
+						if (event.argNames[0] != nullptr)
+						{
+							writer.Key("args");
+							writer.StartObject();
+							for (int argIdx{ 0 }; argIdx < 2 && event.argNames[argIdx] != nullptr; ++argIdx)
+							{
+								writer.Key(event.argNames[argIdx]);
+								writer.Int64(event.argValues[argIdx]);
+							}
+							writer.EndObject();
+						}
+						writer.EndObject();
+					}
+				}
+			}
+			writer.EndArray();
+			writer.Key("displayTimeUnit");
+			writer.String("ms");
+			writer.EndObject();
+
+			ObjWriter file{};
+			if (file.Open(filename) == false) return false;
+			file.Write(stringBuffer.GetString(), stringBuffer.GetSize());
+			return file.Close();
+		}
+
+		bool IsRecording() const { return m_IsRecording.load(std::memory_order_relaxed); }
+
+		void SetThreadName(const char* name, const int threadIdx)
+		{
+			GetThreadBuffer().name = std::string{ name } + " " + std::to_string(threadIdx);
+		}
+
+		void AddEvent(const TraceEvent& event)
+		{
+			GetThreadBuffer().events.push_back(event);
+		}
+
+		//Innermost open span of the calling thread, nullptr when there is none
+		static const char*& GetCurrentSpanName()
+		{
+			thread_local const char* pName{ nullptr };
+			return pName;
+		}
+
+	private:
+		struct ThreadBuffer
+		{
+			uint32_t threadId;
+			std::string name;
+			std::vector<TraceEvent> events;
+		};
+
+		std::mutex m_Mutex{};
+		std::vector<std::unique_ptr<ThreadBuffer>> m_Buffers{};
+		std::chrono::steady_clock::time_point m_Start{};
+		std::atomic<bool> m_IsRecording{ false };
+
+		TraceRecorder() = default;
+
+		//Buffers are kept until the program ends, so threads of pools that are gone still show up in the trace
+		ThreadBuffer& GetThreadBuffer()
+		{
+			thread_local ThreadBuffer* pBuffer{ nullptr };
+			if (pBuffer == nullptr)
+			{
+				std::lock_guard<std::mutex> lock{ m_Mutex };
+				m_Buffers.push_back(std::make_unique<ThreadBuffer>(ThreadBuffer{ static_cast<uint32_t>(m_Buffers.size() + 1), "", {} }));
+				pBuffer = m_Buffers.back().get();
+			}
+			return *pBuffer;
+		}
+	};
+
+	//Records a span from its construction to its destruction, or to End, while the recorder is recording
+	class TraceScope
+	{
+	public:
+		explicit TraceScope(const char* name, const char* argName = nullptr, const int64_t argValue = 0, const char* argName2 = nullptr, const int64_t argValue2 = 0)
+			: m_IsOpen{ TraceRecorder::GetInstance().IsRecording() }
+		{
+			if (m_IsOpen == false) return;
+
+			m_Event = TraceEvent{ name, std::chrono::steady_clock::now(), {}, { argName, argName2 }, { argValue, argValue2 } };
+			m_pParentName = TraceRecorder::GetCurrentSpanName();
+			TraceRecorder::GetCurrentSpanName() = name;
+		}
+
+		~TraceScope()
+		{
+			End();
+		}
+
+		TraceScope(const TraceScope&) = delete;
+		TraceScope& operator=(const TraceScope&) = delete;
+
+		//Ends the span before the scope does, later calls do nothing
+		void End()
+		{
+			if (m_IsOpen == false) return;
+
+			m_Event.duration = std::chrono::steady_clock::now() - m_Event.start;
+			TraceRecorder::GetInstance().AddEvent(m_Event);
+			TraceRecorder::GetCurrentSpanName() = m_pParentName;
+			m_IsOpen = false;
+		}
+
+	private:
+		bool m_IsOpen;
+		TraceEvent m_Event{};
+		const char* m_pParentName{ nullptr };
+	};
+}
+
+#define COMMONCODE_TRACE_CONCAT_IMPL(a, b) a##b
+#define COMMONCODE_TRACE_CONCAT(a, b) COMMONCODE_TRACE_CONCAT_IMPL(a, b)
+
+//COMMONCODE_TRACE_SCOPE(name[, argName, argValue[, argName2, argValue2]]) spans the rest of the enclosing scope
+#define COMMONCODE_TRACE_SCOPE(...) const commonCode::TraceScope COMMONCODE_TRACE_CONCAT(traceScope, __LINE__){ __VA_ARGS__ }
+#define COMMONCODE_TRACE_THREAD(name, threadIdx) commonCode::TraceRecorder::GetInstance().SetThreadName(name, threadIdx)
+#else
+#define COMMONCODE_TRACE_SCOPE(...)
+#define COMMONCODE_TRACE_THREAD(name, threadIdx)
+#endif
@@ -0,0 +1,100 @@
+#pragma once
+#include <cstdint>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define COMMONCODE_X86 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#include <immintrin.h>
+#endif
+
+//MSVC allows any intrinsic in any function, GCC and Clang need the target enabled per function
+#if defined(__GNUC__) || defined(__clang__)
+#define COMMONCODE_TARGET_SSE2 __attribute__((target("sse2")))
+#define COMMONCODE_TARGET_SSE42 __attribute__((target("sse4.2")))
+#define COMMONCODE_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define COMMONCODE_TARGET_SSE2
+#define COMMONCODE_TARGET_SSE42
+#define COMMONCODE_TARGET_AVX2
+#endif
+
+namespace commonCode
+{
+	enum class SimdLevel
+	{
+		SCALAR,
+		SSE2,
+		SSE42,
+		AVX2,
+	};
+
+	inline const wchar_t* ToString(const SimdLevel level)
+	{
+		switch (level)
+		{
+		case SimdLevel::SSE2: return L"SSE2";
+		case SimdLevel::SSE42: return L"SSE4.2";
+		case SimdLevel::AVX2: return L"AVX2";
+		case SimdLevel::SCALAR:
+		default: return L"scalar";
+		}
+	}
+
+	inline SimdLevel DetectSimdLevel()
+	{
+#if defined(COMMONCODE_X86)
+		uint32_t regs[4]{};
+		auto cpuid = [&regs](const uint32_t leaf, const uint32_t subLeaf)
+		{
+#if defined(_MSC_VER)
+			int msvcRegs[4]{};
+			__cpuidex(msvcRegs, static_cast<int>(leaf), static_cast<int>(subLeaf));
+			for (int i{ 0 }; i < 4; ++i) regs[i] = static_cast<uint32_t>(msvcRegs[i]);
+#else
+			__cpuid_count(leaf, subLeaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+		};
+
+		cpuid(0, 0);
+		const uint32_t maxLeaf{ regs[0] };
+		if (maxLeaf < 1) return SimdLevel::SCALAR;
+
+		cpuid(1, 0);
+		const bool hasSse2{ (regs[3] & (1u << 26)) != 0 };
+		const bool hasSse42{ (regs[2] & (1u << 20)) != 0 };
+		const bool hasOsXSave{ (regs[2] & (1u << 27)) != 0 };
+		const bool hasAvx{ (regs[2] & (1u << 28)) != 0 };
+
+		//AVX registers also have to be saved by the OS
+		bool hasAvx2{ false };
+		if (hasOsXSave && hasAvx && maxLeaf >= 7)
+		{
+#if defined(_MSC_VER)
+			const uint64_t xcr0{ _xgetbv(0) };
+#else
+			uint32_t xcr0Low{}, xcr0High{};
+			__asm__ volatile("xgetbv" : "=a"(xcr0Low), "=d"(xcr0High) : "c"(0));
+			const uint64_t xcr0{ (static_cast<uint64_t>(xcr0High) << 32) | xcr0Low };
+#endif
+			cpuid(7, 0);
+			hasAvx2 = (xcr0 & 0x6) == 0x6 && (regs[1] & (1u << 5)) != 0;
+		}
+
+		if (hasAvx2) return SimdLevel::AVX2;
+		if (hasSse42) return SimdLevel::SSE42;
+		if (hasSse2) return SimdLevel::SSE2;
+#endif
+		return SimdLevel::SCALAR;
+	}
+
+	//Detected once, the result cannot change while the process runs
+	inline SimdLevel GetSimdLevel()
+	{
+		static const SimdLevel simdLevel{ DetectSimdLevel() };
+		return simdLevel;
+	}
+}
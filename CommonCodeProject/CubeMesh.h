@@ -0,0 +1,348 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <tuple>
+#include <cstdint>
+
+#include "VoxelGrid.h"
+#include "WorkerPool.h"
+
+namespace commonCode
+{
+	//Cube vertices are numbered 1 to 8, bit 2 of (idx - 1) is the x offset, bit 1 the y offset and bit 0 the z offset
+	//Texture coordinates are numbered 1 to 4: (0, 0), (1, 0), (0, 1), (1, 1)
+	struct CubeFace
+	{
+		int normalIdx; //1-based vn index
+		int normalAxis;
+		int sAxis; //axis the texture s coordinate runs along
+		int tAxis; //axis the texture t coordinate runs along
+		int vertexIndices[6]; //two triangles
+		int texCoordIndices[6];
+	};
+
+	//Indexed by OpaqueNeighbourPos
+	constexpr CubeFace CUBE_FACES[NEIGHBOUR_COUNT]{
+		{ 6, 0, 2, 1, { 1, 4, 3, 1, 2, 4 }, { 4, 1, 2, 4, 3, 1 } }, //Front
+		{ 5, 0, 2, 1, { 5, 7, 8, 5, 8, 6 }, { 3, 1, 2, 3, 2, 4 } }, //Back
+		{ 2, 2, 0, 1, { 1, 7, 5, 1, 3, 7 }, { 3, 2, 4, 3, 1, 2 } }, //Left
+		{ 1, 2, 0, 1, { 2, 6, 8, 2, 8, 4 }, { 4, 3, 1, 4, 1, 2 } }, //Right
+		{ 3, 1, 0, 2, { 3, 8, 7, 3, 4, 8 }, { 3, 2, 4, 3, 1, 2 } }, //Top
+		{ 4, 1, 0, 2, { 1, 5, 6, 1, 6, 2 }, { 1, 2, 4, 1, 4, 3 } }, //Bottom
+	};
+
+	//Order in which the faces of a block are written
+	constexpr OpaqueNeighbourPos BLOCK_FACE_ORDER[NEIGHBOUR_COUNT]{
+		OpaqueNeighbourPos::LEFT,
+		OpaqueNeighbourPos::FRONT,
+		OpaqueNeighbourPos::TOP,
+		OpaqueNeighbourPos::BACK,
+		OpaqueNeighbourPos::BOTTOM,
+		OpaqueNeighbourPos::RIGHT,
+	};
+
+	//Indexed by normalIdx - 1, in the order the normals are written to an OBJ file
+	constexpr float CUBE_NORMALS[NEIGHBOUR_COUNT][3]{
+		{ 0.f, 0.f, 1.f },
+		{ 0.f, 0.f, -1.f },
+		{ 0.f, 1.f, 0.f },
+		{ 0.f, -1.f, 0.f },
+		{ 1.f, 0.f, 0.f },
+		{ -1.f, 0.f, 0.f },
+	};
+
+	inline int GetCubeVertexOffset(const int vertexIdx, const int axis)
+	{
+		return ((vertexIdx - 1) >> (2 - axis)) & 1;
+	}
+
+	//0 or 1 along s (axis 0) or t (axis 1)
+	inline int GetTexCoordOffset(const int texCoordIdx, const int axis)
+	{
+		return ((texCoordIdx - 1) >> axis) & 1;
+	}
+
+	//The 4 corners of a face, numbered in the order its triangles first use them
+	struct QuadCorners
+	{
+		int vertexIndices[4];
+		int texCoordIndices[4];
+		int triangles[6]; //corner numbers of the two triangles
+		int outline[4]; //corner numbers around the quad, in the winding of the triangles
+	};
+
+	//Indexed by OpaqueNeighbourPos
+	inline std::vector<QuadCorners> BuildQuadCorners()
+	{
+		std::vector<QuadCorners> quadCorners(NEIGHBOUR_COUNT);
+
+		for (int face{ 0 }; face < NEIGHBOUR_COUNT; ++face)
+		{
+			QuadCorners& corners{ quadCorners[face] };
+			int cornerCount{ 0 };
+			for (int i{ 0 }; i < 6; ++i)
+			{
+				const int vertexIdx{ CUBE_FACES[face].vertexIndices[i] };
+				const auto cornerIt{ std::find(corners.vertexIndices, corners.vertexIndices + cornerCount, vertexIdx) };
+				if (cornerIt == corners.vertexIndices + cornerCount)
+				{
+					corners.vertexIndices[cornerCount] = vertexIdx;
+					corners.texCoordIndices[cornerCount] = CUBE_FACES[face].texCoordIndices[i];
+					++cornerCount;
+				}
+
+				corners.triangles[i] = static_cast<int>(cornerIt - corners.vertexIndices);
+			}
+
+			//The corner only the second triangle uses goes between the two corners of the shared edge
+			int outlineCount{ 0 };
+			for (int i{ 0 }; i < 3; ++i)
+			{
+				const int edgeStart{ corners.triangles[i] };
+				const int edgeEnd{ corners.triangles[(i + 1) % 3] };
+				corners.outline[outlineCount++] = edgeStart;
+
+				for (int j{ 0 }; j < 3; ++j)
+				{
+					if (corners.triangles[3 + j] == edgeEnd && corners.triangles[3 + (j + 1) % 3] == edgeStart)
+					{
+						corners.outline[outlineCount++] = corners.triangles[3 + (j + 2) % 3];
+					}
+				}
+			}
+		}
+
+		return quadCorners;
+	}
+
+	//Gives every distinct corner position a single 1-based vertex index, in the order corners are first used
+	class VertexWelder
+	{
+	public:
+		explicit VertexWelder(const size_t expectedCount = 0)
+			: m_VertexLookup{ expectedCount }
+		{
+			m_Positions.reserve(expectedCount * 3);
+		}
+
+		int GetVertexIdx(const int x, const int y, const int z)
+		{
+			const uint32_t newIdx{ static_cast<uint32_t>(GetVertexCount()) };
+			const uint32_t vertexIdx{ m_VertexLookup.Insert(CoordKey{ x, y, z }, newIdx) };
+
+			if (vertexIdx == newIdx)
+			{
+				m_Positions.push_back(x);
+				m_Positions.push_back(y);
+				m_Positions.push_back(z);
+			}
+
+			return static_cast<int>(vertexIdx) + 1;
+		}
+
+		size_t GetVertexCount() const { return m_Positions.size() / 3; }
+
+		//x, y, z of every vertex, in index order
+		const std::vector<int>& GetPositions() const { return m_Positions; }
+
+	private:
+		CoordHashMap m_VertexLookup;
+		std::vector<int> m_Positions{};
+	};
+
+	//Rectangle of merged faces that all point the same way and share a material
+	struct MeshQuad
+	{
+		int pos[3]; //block coordinates of the minimum corner
+		int size[3]; //extent in blocks, 1 along the normal axis
+		uint16_t materialId;
+		uint8_t face; //OpaqueNeighbourPos
+	};
+
+	//Visible face of a single block, in the plane/t/s coordinates of its direction
+	struct FaceCell
+	{
+		uint16_t materialId;
+		int plane;
+		int t;
+		int s;
+	};
+
+	//Faces merged along s
+	struct FaceRun
+	{
+		uint16_t materialId;
+		int plane;
+		int s;
+		int length;
+		int t;
+	};
+
+	//Appends the visible faces of one direction in a chunk
+	inline void AddChunkFaceCells(const VoxelChunk& chunk, const size_t face, std::vector<FaceCell>& cells)
+	{
+		const CubeFace& cubeFace{ CUBE_FACES[face] };
+		const int chunkPos[3]{ chunk.chunkX * CHUNK_SIZE, chunk.chunkY * CHUNK_SIZE, chunk.chunkZ * CHUNK_SIZE };
+
+		for (int z{ 0 }; z < CHUNK_SIZE; ++z)
+		{
+			for (int y{ 0 }; y < CHUNK_SIZE; ++y)
+			{
+				for (uint32_t row{ chunk.faceRows[face][z][y] }; row != 0; row &= row - 1)
+				{
+					int x{ 0 };
+					while (((row >> x) & 1) == 0) ++x;
+
+					const int cellPos[3]{ chunkPos[0] + x, chunkPos[1] + y, chunkPos[2] + z };
+					cells.push_back(FaceCell{
+						chunk.materials[(z * CHUNK_SIZE + y) * CHUNK_SIZE + x],
+						cellPos[cubeFace.normalAxis],
+						cellPos[cubeFace.tAxis],
+						cellPos[cubeFace.sAxis]
+					});
+				}
+			}
+		}
+	}
+
+	//Merges the faces of one direction into maximal rectangles and appends them to quads, cells gets sorted
+	//Runs of faces along s are merged first, then runs with the same start and length on consecutive t rows
+	inline void MergeFaceCells(std::vector<FaceCell>& cells, const size_t face, std::vector<MeshQuad>& quads)
+	{
+		const CubeFace& cubeFace{ CUBE_FACES[face] };
+
+		std::sort(cells.begin(), cells.end(), [](const FaceCell& a, const FaceCell& b)
+			{
+				return std::tie(a.materialId, a.plane, a.t, a.s) < std::tie(b.materialId, b.plane, b.t, b.s);
+			});
+
+		//Merge along s
+		std::vector<FaceRun> runs{};
+		for (const FaceCell& cell : cells)
+		{
+			if (runs.empty() == false)
+			{
+				FaceRun& run{ runs.back() };
+				if (run.materialId == cell.materialId && run.plane == cell.plane && run.t == cell.t && run.s + run.length == cell.s)
+				{
+					++run.length;
+					continue;
+				}
+			}
+
+			runs.push_back(FaceRun{ cell.materialId, cell.plane, cell.s, 1, cell.t });
+		}
+
+		std::sort(runs.begin(), runs.end(), [](const FaceRun& a, const FaceRun& b)
+			{
+				return std::tie(a.materialId, a.plane, a.s, a.length, a.t) < std::tie(b.materialId, b.plane, b.s, b.length, b.t);
+			});
+
+		//Merge equal runs along t, quads that were already in the vector are left alone
+		const size_t firstQuadIdx{ quads.size() };
+		int lastT{ 0 };
+		for (const FaceRun& run : runs)
+		{
+			if (quads.size() > firstQuadIdx)
+			{
+				MeshQuad& quad{ quads.back() };
+				if (quad.materialId == run.materialId && quad.pos[cubeFace.normalAxis] == run.plane
+					&& quad.pos[cubeFace.sAxis] == run.s && quad.size[cubeFace.sAxis] == run.length && lastT + 1 == run.t)
+				{
+					++quad.size[cubeFace.tAxis];
+					lastT = run.t;
+					continue;
+				}
+			}
+
+			MeshQuad quad{};
+			quad.pos[cubeFace.normalAxis] = run.plane;
+			quad.pos[cubeFace.sAxis] = run.s;
+			quad.pos[cubeFace.tAxis] = run.t;
+			quad.size[cubeFace.normalAxis] = 1;
+			quad.size[cubeFace.sAxis] = run.length;
+			quad.size[cubeFace.tAxis] = 1;
+			quad.materialId = run.materialId;
+			quad.face = static_cast<uint8_t>(face);
+			quads.push_back(quad);
+			lastT = run.t;
+		}
+	}
+
+	//Merges the visible faces of every direction into maximal rectangles
+	//Quads are sorted by material, then by face direction, so the output is deterministic
+	inline std::vector<MeshQuad> BuildGreedyQuads(const VoxelGrid& grid, WorkerPool& workerPool)
+	{
+		std::vector<std::vector<MeshQuad>> faceQuads(NEIGHBOUR_COUNT);
+
+		workerPool.ParallelFor(NEIGHBOUR_COUNT, 1,
+			[&grid, &faceQuads](const size_t begin, const size_t end, const int)
+			{
+				for (size_t face{ begin }; face < end; ++face)
+				{
+					COMMONCODE_TRACE_SCOPE("merge faces", "face", static_cast<int64_t>(face));
+
+					//Collect visible faces
+					std::vector<FaceCell> cells{};
+					for (const VoxelChunk& chunk : grid.GetChunks())
+					{
+						AddChunkFaceCells(chunk, face, cells);
+					}
+
+					MergeFaceCells(cells, face, faceQuads[face]);
+				}
+			}
+		);
+
+		std::vector<MeshQuad> quads{};
+		for (const std::vector<MeshQuad>& directionQuads : faceQuads)
+		{
+			quads.insert(quads.end(), directionQuads.begin(), directionQuads.end());
+		}
+
+		std::stable_sort(quads.begin(), quads.end(), [](const MeshQuad& a, const MeshQuad& b)
+			{
+				return a.materialId < b.materialId;
+			});
+
+		return quads;
+	}
+
+	//Appends the quads of a single chunk, sorted by material, the faces have to be culled already
+	//With mergeFaces the faces are merged within the chunk only, so the quads of a chunk don't depend on its neighbours' cells
+	inline void BuildChunkQuads(const VoxelChunk& chunk, const bool mergeFaces, std::vector<MeshQuad>& quads)
+	{
+		const size_t firstQuadIdx{ quads.size() };
+		std::vector<FaceCell> cells{};
+
+		for (size_t face{ 0 }; face < NEIGHBOUR_COUNT; ++face)
+		{
+			cells.clear();
+			AddChunkFaceCells(chunk, face, cells);
+
+			if (mergeFaces)
+			{
+				MergeFaceCells(cells, face, quads);
+				continue;
+			}
+
+			const CubeFace& cubeFace{ CUBE_FACES[face] };
+			for (const FaceCell& cell : cells)
+			{
+				MeshQuad quad{};
+				quad.pos[cubeFace.normalAxis] = cell.plane;
+				quad.pos[cubeFace.sAxis] = cell.s;
+				quad.pos[cubeFace.tAxis] = cell.t;
+				quad.size[0] = quad.size[1] = quad.size[2] = 1;
+				quad.materialId = cell.materialId;
+				quad.face = static_cast<uint8_t>(face);
+				quads.push_back(quad);
+			}
+		}
+
+		std::stable_sort(quads.begin() + firstQuadIdx, quads.end(), [](const MeshQuad& a, const MeshQuad& b)
+			{
+				return a.materialId < b.materialId;
+			});
+	}
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdlib>
+
+#include "ObjWriter.h"
+
+namespace commonCode
+{
+	//A client sends one job line and the daemon answers with one result line
+	//Lines are UTF-8 fields separated by tabs, tabs, newlines and backslashes inside a field are escaped
+	struct DaemonJob
+	{
+		std::wstring inputFilename;
+		std::wstring outputFilename; //empty --> input file name with the format extension
+		std::wstring format; //obj, glb, ply or stl, empty --> extension of the output file
+		std::wstring report; //blocks or layers, empty --> no report
+	};
+
+	struct DaemonResult
+	{
+		int status; //0 or -1 like the conversion functions
+		double time; //seconds the daemon spent on the job
+		std::wstring message;
+		std::wstring report;
+	};
+
+	inline std::string EscapeDaemonField(const std::wstring& field)
+	{
+		const std::string utf8Field{ ToUtf8(field) };
+
+		std::string escapedField{};
+		escapedField.reserve(utf8Field.size());
+		for (const char c : utf8Field)
+		{
+			switch (c)
+			{
+			case '\\': escapedField += "\\\\"; break;
+			case '\t': escapedField += "\\t"; break;
+			case '\n': escapedField += "\\n"; break;
+			case '\r': escapedField += "\\r"; break;
+			default: escapedField += c; break;
+			}
+		}
+		return escapedField;
+	}
+
+	inline std::vector<std::wstring> SplitDaemonLine(const std::string& line)
+	{
+		std::vector<std::wstring> fields{};
+		std::string field{};
+		for (size_t i{ 0 }; i <= line.size(); ++i)
+		{
+			if (i == line.size() || line[i] == '\t')
+			{
+				fields.push_back(FromUtf8(field));
+				field.clear();
+			}
+			else if (line[i] == '\\' && i + 1 < line.size())
+			{
+				const char c{ line[++i] };
+				field += (c == 't') ? '\t' : (c == 'n') ? '\n' : (c == 'r') ? '\r' : c;
+			}
+			else
+			{
+				field += line[i];
+			}
+		}
+		return fields;
+	}
+
+	inline std::string EncodeDaemonJob(const DaemonJob& job)
+	{
+		return EscapeDaemonField(job.inputFilename) + "\t" + EscapeDaemonField(job.outputFilename) + "\t"
+			+ EscapeDaemonField(job.format) + "\t" + EscapeDaemonField(job.report);
+	}
+
+	inline bool DecodeDaemonJob(const std::string& line, DaemonJob& job)
+	{
+		const std::vector<std::wstring> fields{ SplitDaemonLine(line) };
+		if (fields.size() != 4) return false;
+
+		job = DaemonJob{ fields[0], fields[1], fields[2], fields[3] };
+		return true;
+	}
+
+	inline std::string EncodeDaemonResult(const DaemonResult& result)
+	{
+		return std::to_string(result.status) + "\t" + std::to_string(result.time) + "\t"
+			+ EscapeDaemonField(result.message) + "\t" + EscapeDaemonField(result.report);
+	}
+
+	inline bool DecodeDaemonResult(const std::string& line, DaemonResult& result)
+	{
+		const std::vector<std::wstring> fields{ SplitDaemonLine(line) };
+		if (fields.size() != 4) return false;
+
+		result = DaemonResult{ static_cast<int>(wcstol(fields[0].c_str(), nullptr, 10)), wcstod(fields[1].c_str(), nullptr), fields[2], fields[3] };
+		return true;
+	}
+}
@@ -0,0 +1,185 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include <cwchar>
+#include <chrono>
+#include <thread>
+
+#include "MappedFile.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/inotify.h>
+#endif
+#endif
+
+namespace commonCode
+{
+	//Waits for a single file to be written
+	//Watches the directory of the file so editors that save by replacing the file are noticed too
+	//Windows uses ReadDirectoryChangesW, Linux inotify and other systems check the file every 250 ms
+	class FileWatcher
+	{
+	public:
+		FileWatcher() = default;
+
+		~FileWatcher()
+		{
+			Close();
+		}
+
+		FileWatcher(const FileWatcher&) = delete;
+		FileWatcher& operator=(const FileWatcher&) = delete;
+
+		bool Open(const std::wstring& filename)
+		{
+			Close();
+
+			const size_t lastSlashIdx{ filename.find_last_of(L"\\/") };
+			const std::wstring directory{ (lastSlashIdx != std::wstring::npos) ? filename.substr(0, lastSlashIdx + 1) : L"." };
+			m_Filename = filename;
+			m_Name = (lastSlashIdx != std::wstring::npos) ? filename.substr(lastSlashIdx + 1) : filename;
+			GetStamp(m_Stamp);
+
+#if defined(_WIN32)
+			m_Directory = CreateFileW(directory.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+				nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, nullptr);
+			return m_Directory != INVALID_HANDLE_VALUE;
+#elif defined(__linux__)
+			std::string directoryStr{};
+			if (ToMultiByteFilename(directory, directoryStr) == false || ToMultiByteFilename(m_Name, m_NameStr) == false) return false;
+
+			m_Inotify = inotify_init1(IN_CLOEXEC);
+			if (m_Inotify == -1) return false;
+
+			if (inotify_add_watch(m_Inotify, directoryStr.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) == -1)
+			{
+				Close();
+				return false;
+			}
+			return true;
+#else
+			return true;
+#endif
+		}
+
+		void Close()
+		{
+#if defined(_WIN32)
+			if (m_Directory != INVALID_HANDLE_VALUE) CloseHandle(m_Directory);
+			m_Directory = INVALID_HANDLE_VALUE;
+#elif defined(__linux__)
+			if (m_Inotify != -1) close(m_Inotify);
+			m_Inotify = -1;
+#endif
+		}
+
+		//Blocks until the file has a new write time or size, returns false when the directory can't be watched anymore
+		bool WaitForChange()
+		{
+			while (true)
+			{
+				if (WaitForEvent() == false) return false;
+
+				//Editors write in several steps, give them a moment to finish
+				std::this_thread::sleep_for(std::chrono::milliseconds{ 50 });
+
+				//One save raises several notifications, only the first sees a new stamp
+				FileStamp stamp{};
+				if (GetStamp(stamp) == false || (stamp.writeTime == m_Stamp.writeTime && stamp.size == m_Stamp.size)) continue;
+
+				m_Stamp = stamp;
+				return true;
+			}
+		}
+
+	private:
+		struct FileStamp
+		{
+			int64_t writeTime;
+			int64_t size;
+		};
+
+		std::wstring m_Filename{};
+		std::wstring m_Name{};
+		FileStamp m_Stamp{};
+#if defined(_WIN32)
+		HANDLE m_Directory{ INVALID_HANDLE_VALUE };
+#elif defined(__linux__)
+		std::string m_NameStr{};
+		int m_Inotify{ -1 };
+#endif
+
+		bool GetStamp(FileStamp& stamp) const
+		{
+#if defined(_WIN32)
+			WIN32_FILE_ATTRIBUTE_DATA attributes{};
+			if (GetFileAttributesExW(m_Filename.c_str(), GetFileExInfoStandard, &attributes) == FALSE) return false;
+
+			stamp.writeTime = (static_cast<int64_t>(attributes.ftLastWriteTime.dwHighDateTime) << 32) | attributes.ftLastWriteTime.dwLowDateTime;
+			stamp.size = (static_cast<int64_t>(attributes.nFileSizeHigh) << 32) | attributes.nFileSizeLow;
+#else
+			std::string filenameStr{};
+			struct stat fileStat{};
+			if (ToMultiByteFilename(m_Filename, filenameStr) == false || stat(filenameStr.c_str(), &fileStat) != 0) return false;
+
+#if defined(__linux__)
+			stamp.writeTime = static_cast<int64_t>(fileStat.st_mtim.tv_sec) * 1000000000 + fileStat.st_mtim.tv_nsec;
+#else
+			stamp.writeTime = static_cast<int64_t>(fileStat.st_mtime);
+#endif
+			stamp.size = static_cast<int64_t>(fileStat.st_size);
+#endif
+			return true;
+		}
+
+		//Returns once something happened to a file with the watched name
+		bool WaitForEvent()
+		{
+#if defined(_WIN32)
+			alignas(DWORD) char buffer[4096];
+			while (true)
+			{
+				DWORD size{ 0 };
+				if (ReadDirectoryChangesW(m_Directory, buffer, sizeof(buffer), FALSE,
+					FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE, &size, nullptr, nullptr) == FALSE) return false;
+
+				//The buffer overflowed, the stamp tells whether the file changed
+				if (size == 0) return true;
+
+				for (const char* p{ buffer };;)
+				{
+					const FILE_NOTIFY_INFORMATION* pInfo{ reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(p) };
+					const std::wstring name{ pInfo->FileName, pInfo->FileNameLength / sizeof(WCHAR) };
+					if (_wcsicmp(name.c_str(), m_Name.c_str()) == 0) return true;
+
+					if (pInfo->NextEntryOffset == 0) break;
+					p += pInfo->NextEntryOffset;
+				}
+			}
+#elif defined(__linux__)
+			alignas(inotify_event) char buffer[4096];
+			while (true)
+			{
+				const ssize_t size{ read(m_Inotify, buffer, sizeof(buffer)) };
+				if (size <= 0) return false;
+
+				for (const char* p{ buffer }; p < buffer + size;)
+				{
+					const inotify_event* pEvent{ reinterpret_cast<const inotify_event*>(p) };
+					if ((pEvent->mask & IN_Q_OVERFLOW) != 0 || (pEvent->len > 0 && m_NameStr == pEvent->name)) return true;
+
+					p += sizeof(inotify_event) + pEvent->len;
+				}
+			}
+#else
+			std::this_thread::sleep_for(std::chrono::milliseconds{ 250 });
+			return true;
+#endif
+		}
+	};
+}
@@ -0,0 +1,619 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <cstdint>
+#include <cstring>
+#include <cfloat>
+#include <algorithm>
+
+#include "rapidjson/writer.h"
+#include "rapidjson/stringbuffer.h"
+
+#include "CubeMesh.h"
+#include "WorkerPool.h"
+#include "ObjWriter.h"
+
+namespace commonCode
+{
+	//Material of an .mtl file, only what the glTF export uses
+	struct MtlMaterial
+	{
+		std::string name; //UTF-8
+		float diffuse[3]{ 1.f, 1.f, 1.f };
+		float opacity{ 1.f };
+		std::string texture; //map_Kd, with forward slashes
+	};
+
+	//Reads newmtl, Kd, d and map_Kd, other statements are skipped
+	//A missing file gives no materials
+	inline std::vector<MtlMaterial> ReadMtlFile(const std::wstring& filename)
+	{
+		std::vector<MtlMaterial> mtlMaterials{};
+
+		std::ifstream is{ filename };
+		std::string line{};
+		while (std::getline(is, line))
+		{
+			if (line.empty() == false && line.back() == '\r') line.pop_back();
+
+			std::istringstream lineStream{ line };
+			std::string keyword{};
+			lineStream >> keyword;
+
+			if (keyword.compare("newmtl") == 0)
+			{
+				mtlMaterials.emplace_back();
+				lineStream >> mtlMaterials.back().name;
+			}
+			else if (mtlMaterials.empty())
+			{
+				continue;
+			}
+			else if (keyword.compare("Kd") == 0)
+			{
+				float* diffuse{ mtlMaterials.back().diffuse };
+				lineStream >> diffuse[0] >> diffuse[1] >> diffuse[2];
+			}
+			else if (keyword.compare("d") == 0)
+			{
+				lineStream >> mtlMaterials.back().opacity;
+			}
+			else if (keyword.compare("map_Kd") == 0)
+			{
+				std::string& texture{ mtlMaterials.back().texture };
+				std::getline(lineStream >> std::ws, texture);
+				std::replace(texture.begin(), texture.end(), '\\', '/');
+			}
+		}
+
+		return mtlMaterials;
+	}
+
+	//Quads of one material, written as one glTF primitive
+	struct GlbPrimitive
+	{
+		uint16_t materialId;
+		size_t firstQuad; //in GlbLayout::quadOrder
+		size_t quadCount;
+		bool hasShortIndices; //uint16 instead of uint32
+		size_t indexOffset; //in the index buffer view
+		float min[3];
+		float max[3];
+	};
+
+	//Blocks of one material drawn as instances of a unit cube through EXT_mesh_gpu_instancing
+	struct GlbInstanceGroup
+	{
+		uint16_t materialId;
+		std::vector<float> translations; //minimum corner of every block, 3 floats each
+	};
+
+	//Quads of the unit cube the instance groups share, one per face
+	constexpr size_t UNIT_CUBE_QUAD_COUNT{ NEIGHBOUR_COUNT };
+
+	//Where everything goes in a .glb file
+	//The binary chunk holds all positions, then all normals, then all texture coordinates, then the indices of every primitive, then the instance translations
+	//With instance groups the unit cube comes first in the vertex and index data
+	struct GlbLayout
+	{
+		std::vector<uint32_t> quadOrder; //quads grouped by material
+		std::vector<GlbPrimitive> primitives;
+		size_t cubeQuadCount; //UNIT_CUBE_QUAD_COUNT with instance groups, else 0
+		size_t translationsOffset; //in the binary chunk
+		std::string json; //padded with spaces to a multiple of 4
+		size_t binOffset; //start of the binary chunk data in the file
+		size_t binSize; //padded with zeros to a multiple of 4
+		size_t fileSize;
+	};
+
+	constexpr uint32_t GLB_MAGIC{ 0x46546C67 }; //"glTF"
+	constexpr uint32_t GLB_JSON_CHUNK{ 0x4E4F534A }; //"JSON"
+	constexpr uint32_t GLB_BIN_CHUNK{ 0x004E4942 }; //"BIN\0"
+	constexpr size_t GLB_HEADER_SIZE{ 12 };
+	constexpr size_t GLB_CHUNK_HEADER_SIZE{ 8 };
+
+	//Groups the quads by material and writes the glTF JSON of the scene
+	//Every quad gets 4 vertices of its own since corners of different faces have different normals
+	//The quads form one mesh, every instance group gets a mesh and node of its own that draws the unit cube
+	inline GlbLayout BuildGlbLayout(const std::vector<MeshQuad>& quads, const std::vector<GlbInstanceGroup>& instanceGroups, const std::vector<std::wstring>& layerNames, const std::vector<MtlMaterial>& mtlMaterials)
+	{
+		GlbLayout layout{};
+
+		//Stable counting sort by material
+		std::vector<size_t> materialOffsets(static_cast<size_t>(EMPTY_MATERIAL) + 1, 0);
+		for (const MeshQuad& quad : quads) ++materialOffsets[quad.materialId + 1];
+		for (size_t materialId{ 1 }; materialId < materialOffsets.size(); ++materialId) materialOffsets[materialId] += materialOffsets[materialId - 1];
+
+		layout.quadOrder.resize(quads.size());
+		for (size_t i{ 0 }; i < quads.size(); ++i)
+		{
+			layout.quadOrder[materialOffsets[quads[i].materialId]++] = static_cast<uint32_t>(i);
+		}
+
+		//One primitive per material, with the bounds glTF requires for positions
+		layout.cubeQuadCount = instanceGroups.empty() ? 0 : UNIT_CUBE_QUAD_COUNT;
+		size_t indexSize{ layout.cubeQuadCount * 6 * sizeof(uint16_t) };
+		for (size_t orderIdx{ 0 }; orderIdx < layout.quadOrder.size(); ++orderIdx)
+		{
+			const MeshQuad& quad{ quads[layout.quadOrder[orderIdx]] };
+			if (layout.primitives.empty() || layout.primitives.back().materialId != quad.materialId)
+			{
+				layout.primitives.push_back(GlbPrimitive{ quad.materialId, orderIdx, 0, true, 0, { FLT_MAX, FLT_MAX, FLT_MAX }, { -FLT_MAX, -FLT_MAX, -FLT_MAX } });
+			}
+
+			GlbPrimitive& primitive{ layout.primitives.back() };
+			++primitive.quadCount;
+			for (int axis{ 0 }; axis < 3; ++axis)
+			{
+				primitive.min[axis] = (std::min)(primitive.min[axis], static_cast<float>(quad.pos[axis]));
+				primitive.max[axis] = (std::max)(primitive.max[axis], static_cast<float>(quad.pos[axis] + quad.size[axis]));
+			}
+		}
+
+		//The largest index value of a component type is not allowed
+		for (GlbPrimitive& primitive : layout.primitives)
+		{
+			primitive.hasShortIndices = primitive.quadCount * 4 <= UINT16_MAX;
+			primitive.indexOffset = indexSize;
+			indexSize += primitive.quadCount * 6 * (primitive.hasShortIndices ? sizeof(uint16_t) : sizeof(uint32_t));
+			indexSize = (indexSize + 3) & ~size_t{ 3 };
+		}
+
+		size_t translationsSize{ 0 };
+		for (const GlbInstanceGroup& instanceGroup : instanceGroups) translationsSize += instanceGroup.translations.size() * sizeof(float);
+
+		const size_t vertexCount{ (layout.cubeQuadCount + quads.size()) * 4 };
+		const size_t positionsOffset{ 0 };
+		const size_t normalsOffset{ vertexCount * 3 * sizeof(float) };
+		const size_t texCoordsOffset{ normalsOffset * 2 };
+		const size_t indicesOffset{ texCoordsOffset + vertexCount * 2 * sizeof(float) };
+		layout.translationsOffset = indicesOffset + indexSize;
+		layout.binSize = layout.translationsOffset + translationsSize;
+
+		//Materials of the merged primitives, then those of the instance groups
+		std::vector<uint16_t> materialIds{};
+		for (const GlbPrimitive& primitive : layout.primitives) materialIds.push_back(primitive.materialId);
+		for (const GlbInstanceGroup& instanceGroup : instanceGroups) materialIds.push_back(instanceGroup.materialId);
+
+		const bool hasMergedMesh{ layout.primitives.empty() == false };
+		const size_t nodeCount{ (hasMergedMesh ? 1 : 0) + instanceGroups.size() };
+
+		//Accessors: 4 per merged primitive, 4 for the unit cube, 1 translation accessor per instance group
+		const size_t cubeAccessorIdx{ layout.primitives.size() * 4 };
+		const size_t firstTranslationAccessorIdx{ cubeAccessorIdx + 4 };
+
+		//JSON
+		rapidjson::StringBuffer jsonBuffer{};
+		rapidjson::Writer<rapidjson::StringBuffer> writer{ jsonBuffer };
+		writer.StartObject();
+
+		writer.Key("asset");
+		writer.StartObject();
+		writer.Key("version");
+		writer.String("2.0");
+		writer.Key("generator");
+		writer.String("MinecraftTool");
+		writer.EndObject();
+
+		writer.Key("scene");
+		writer.Uint(0);
+		writer.Key("scenes");
+		writer.StartArray();
+		writer.StartObject();
+		if (nodeCount != 0)
+		{
+			writer.Key("nodes");
+			writer.StartArray();
+			for (size_t nodeIdx{ 0 }; nodeIdx < nodeCount; ++nodeIdx) writer.Uint64(nodeIdx);
+			writer.EndArray();
+		}
+		writer.EndObject();
+		writer.EndArray();
+
+		if (nodeCount != 0)
+		{
+			//Without the extension every instance group would show as a single cube, so readers have to support it
+			if (instanceGroups.empty() == false)
+			{
+				for (const char* key : { "extensionsUsed", "extensionsRequired" })
+				{
+					writer.Key(key);
+					writer.StartArray();
+					writer.String("EXT_mesh_gpu_instancing");
+					writer.EndArray();
+				}
+			}
+
+			writer.Key("nodes");
+			writer.StartArray();
+			if (hasMergedMesh)
+			{
+				writer.StartObject();
+				writer.Key("mesh");
+				writer.Uint(0);
+				writer.EndObject();
+			}
+			for (size_t groupIdx{ 0 }; groupIdx < instanceGroups.size(); ++groupIdx)
+			{
+				writer.StartObject();
+				writer.Key("mesh");
+				writer.Uint64((hasMergedMesh ? 1 : 0) + groupIdx);
+				writer.Key("extensions");
+				writer.StartObject();
+				writer.Key("EXT_mesh_gpu_instancing");
+				writer.StartObject();
+				writer.Key("attributes");
+				writer.StartObject();
+				writer.Key("TRANSLATION");
+				writer.Uint64(firstTranslationAccessorIdx + groupIdx);
+				writer.EndObject();
+				writer.EndObject();
+				writer.EndObject();
+				writer.EndObject();
+			}
+			writer.EndArray();
+
+			//Every primitive uses 4 accessors: positions, normals, texture coordinates and indices
+			auto writePrimitive = [&writer](const size_t accessorIdx, const size_t materialIdx)
+			{
+				writer.StartObject();
+				writer.Key("attributes");
+				writer.StartObject();
+				writer.Key("POSITION");
+				writer.Uint64(accessorIdx);
+				writer.Key("NORMAL");
+				writer.Uint64(accessorIdx + 1);
+				writer.Key("TEXCOORD_0");
+				writer.Uint64(accessorIdx + 2);
+				writer.EndObject();
+				writer.Key("indices");
+				writer.Uint64(accessorIdx + 3);
+				writer.Key("material");
+				writer.Uint64(materialIdx);
+				writer.EndObject();
+			};
+
+			writer.Key("meshes");
+			writer.StartArray();
+			if (hasMergedMesh)
+			{
+				writer.StartObject();
+				writer.Key("primitives");
+				writer.StartArray();
+				for (size_t primitiveIdx{ 0 }; primitiveIdx < layout.primitives.size(); ++primitiveIdx)
+				{
+					writePrimitive(primitiveIdx * 4, primitiveIdx);
+				}
+				writer.EndArray();
+				writer.EndObject();
+			}
+			for (size_t groupIdx{ 0 }; groupIdx < instanceGroups.size(); ++groupIdx)
+			{
+				writer.StartObject();
+				writer.Key("primitives");
+				writer.StartArray();
+				writePrimitive(cubeAccessorIdx, layout.primitives.size() + groupIdx);
+				writer.EndArray();
+				writer.EndObject();
+			}
+			writer.EndArray();
+
+			auto writeAccessor = [&writer](const unsigned int bufferView, const size_t byteOffset, const unsigned int componentType, const size_t count, const char* type)
+			{
+				writer.Key("bufferView");
+				writer.Uint(bufferView);
+				writer.Key("byteOffset");
+				writer.Uint64(byteOffset);
+				writer.Key("componentType");
+				writer.Uint(componentType);
+				writer.Key("count");
+				writer.Uint64(count);
+				writer.Key("type");
+				writer.String(type);
+			};
+
+			auto writeVertexAccessors = [&writer, &writeAccessor](const size_t firstVertex, const size_t count, const float* min, const float* max)
+			{
+				writer.StartObject();
+				writeAccessor(0, firstVertex * 3 * sizeof(float), 5126, count, "VEC3");
+				writer.Key("min");
+				writer.StartArray();
+				for (int axis{ 0 }; axis < 3; ++axis) writer.Double(min[axis]);
+				writer.EndArray();
+				writer.Key("max");
+				writer.StartArray();
+				for (int axis{ 0 }; axis < 3; ++axis) writer.Double(max[axis]);
+				writer.EndArray();
+				writer.EndObject();
+
+				writer.StartObject();
+				writeAccessor(1, firstVertex * 3 * sizeof(float), 5126, count, "VEC3");
+				writer.EndObject();
+
+				writer.StartObject();
+				writeAccessor(2, firstVertex * 2 * sizeof(float), 5126, count, "VEC2");
+				writer.EndObject();
+			};
+
+			writer.Key("accessors");
+			writer.StartArray();
+			for (const GlbPrimitive& primitive : layout.primitives)
+			{
+				writeVertexAccessors((layout.cubeQuadCount + primitive.firstQuad) * 4, primitive.quadCount * 4, primitive.min, primitive.max);
+
+				writer.StartObject();
+				writeAccessor(3, primitive.indexOffset, primitive.hasShortIndices ? 5123 : 5125, primitive.quadCount * 6, "SCALAR");
+				writer.EndObject();
+			}
+			if (instanceGroups.empty() == false)
+			{
+				const float cubeMin[]{ 0.f, 0.f, 0.f };
+				const float cubeMax[]{ 1.f, 1.f, 1.f };
+				writeVertexAccessors(0, layout.cubeQuadCount * 4, cubeMin, cubeMax);
+
+				writer.StartObject();
+				writeAccessor(3, 0, 5123, layout.cubeQuadCount * 6, "SCALAR");
+				writer.EndObject();
+
+				size_t translationOffset{ 0 };
+				for (const GlbInstanceGroup& instanceGroup : instanceGroups)
+				{
+					writer.StartObject();
+					writeAccessor(4, translationOffset, 5126, instanceGroup.translations.size() / 3, "VEC3");
+					writer.EndObject();
+					translationOffset += instanceGroup.translations.size() * sizeof(float);
+				}
+			}
+			writer.EndArray();
+
+			//Instance attributes are not vertex data, so their view has no target
+			writer.Key("bufferViews");
+			writer.StartArray();
+			const size_t viewOffsets[]{ positionsOffset, normalsOffset, texCoordsOffset, indicesOffset, layout.translationsOffset };
+			const size_t viewSizes[]{ normalsOffset, normalsOffset, indicesOffset - texCoordsOffset, indexSize, translationsSize };
+			const int viewCount{ instanceGroups.empty() ? 4 : 5 };
+			for (int viewIdx{ 0 }; viewIdx < viewCount; ++viewIdx)
+			{
+				writer.StartObject();
+				writer.Key("buffer");
+				writer.Uint(0);
+				writer.Key("byteOffset");
+				writer.Uint64(viewOffsets[viewIdx]);
+				writer.Key("byteLength");
+				writer.Uint64(viewSizes[viewIdx]);
+				if (viewIdx < 4)
+				{
+					writer.Key("target");
+					writer.Uint(viewIdx < 3 ? 34962 : 34963); //ARRAY_BUFFER, ELEMENT_ARRAY_BUFFER
+				}
+				writer.EndObject();
+			}
+			writer.EndArray();
+
+			writer.Key("buffers");
+			writer.StartArray();
+			writer.StartObject();
+			writer.Key("byteLength");
+			writer.Uint64(layout.binSize);
+			writer.EndObject();
+			writer.EndArray();
+
+			//Materials follow the .mtl file, textures are referenced next to the .glb like the .obj does
+			std::vector<std::string> images{};
+			writer.Key("materials");
+			writer.StartArray();
+			for (const uint16_t materialId : materialIds)
+			{
+				const std::string materialName{ ToUtf8(layerNames[materialId]) };
+				const auto mtlIt{ std::find_if(mtlMaterials.begin(), mtlMaterials.end(), [&materialName](const MtlMaterial& mtlMaterial) { return mtlMaterial.name == materialName; }) };
+				const MtlMaterial mtlMaterial{ (mtlIt != mtlMaterials.end()) ? *mtlIt : MtlMaterial{} };
+
+				writer.StartObject();
+				writer.Key("name");
+				writer.String(materialName.c_str(), static_cast<rapidjson::SizeType>(materialName.size()));
+				writer.Key("pbrMetallicRoughness");
+				writer.StartObject();
+				writer.Key("baseColorFactor");
+				writer.StartArray();
+				for (const float value : mtlMaterial.diffuse) writer.Double(value);
+				writer.Double(mtlMaterial.opacity);
+				writer.EndArray();
+				writer.Key("metallicFactor");
+				writer.Double(0.0);
+				writer.Key("roughnessFactor");
+				writer.Double(1.0);
+				if (mtlMaterial.texture.empty() == false)
+				{
+					auto imageIt{ std::find(images.begin(), images.end(), mtlMaterial.texture) };
+					if (imageIt == images.end()) imageIt = images.insert(images.end(), mtlMaterial.texture);
+
+					writer.Key("baseColorTexture");
+					writer.StartObject();
+					writer.Key("index");
+					writer.Uint(static_cast<unsigned int>(imageIt - images.begin()));
+					writer.EndObject();
+				}
+				writer.EndObject();
+				if (mtlMaterial.opacity < 1.f)
+				{
+					writer.Key("alphaMode");
+					writer.String("BLEND");
+				}
+				writer.EndObject();
+			}
+			writer.EndArray();
+
+			if (images.empty() == false)
+			{
+				//Block textures are pixel art, so they are sampled without filtering
+				writer.Key("samplers");
+				writer.StartArray();
+				writer.StartObject();
+				writer.Key("magFilter");
+				writer.Uint(9728); //NEAREST
+				writer.Key("minFilter");
+				writer.Uint(9984); //NEAREST_MIPMAP_NEAREST
+				writer.EndObject();
+				writer.EndArray();
+
+				writer.Key("images");
+				writer.StartArray();
+				for (const std::string& image : images)
+				{
+					writer.StartObject();
+					writer.Key("uri");
+					writer.String(image.c_str(), static_cast<rapidjson::SizeType>(image.size()));
+					writer.EndObject();
+				}
+				writer.EndArray();
+
+				writer.Key("textures");
+				writer.StartArray();
+				for (size_t imageIdx{ 0 }; imageIdx < images.size(); ++imageIdx)
+				{
+					writer.StartObject();
+					writer.Key("sampler");
+					writer.Uint(0);
+					writer.Key("source");
+					writer.Uint(static_cast<unsigned int>(imageIdx));
+					writer.EndObject();
+				}
+				writer.EndArray();
+			}
+		}
+
+		writer.EndObject();
+
+		layout.json.assign(jsonBuffer.GetString(), jsonBuffer.GetSize());
+		layout.json.resize((layout.json.size() + 3) & ~size_t{ 3 }, ' ');
+
+		layout.binOffset = GLB_HEADER_SIZE + GLB_CHUNK_HEADER_SIZE + layout.json.size() + GLB_CHUNK_HEADER_SIZE;
+		layout.fileSize = (layout.binSize != 0) ? layout.binOffset + layout.binSize : layout.binOffset - GLB_CHUNK_HEADER_SIZE;
+		return layout;
+	}
+
+	//Quads per task when the binary chunk is filled
+	constexpr size_t GLB_RANGE_SIZE{ 16 * 1024 };
+
+	//Writes the 4 vertices of a quad, starting at vertexIdx
+	inline void WriteGlbQuadVertices(const MeshQuad& quad, const QuadCorners& corners, const size_t vertexIdx, float* pPositions, float* pNormals, float* pTexCoords)
+	{
+		const CubeFace& cubeFace{ CUBE_FACES[quad.face] };
+		const float* normal{ CUBE_NORMALS[cubeFace.normalIdx - 1] };
+
+		for (int corner{ 0 }; corner < 4; ++corner)
+		{
+			const size_t idx{ vertexIdx + corner };
+			for (int axis{ 0 }; axis < 3; ++axis)
+			{
+				pPositions[idx * 3 + axis] = static_cast<float>(quad.pos[axis] + GetCubeVertexOffset(corners.vertexIndices[corner], axis) * quad.size[axis]);
+				pNormals[idx * 3 + axis] = normal[axis];
+			}
+
+			//Textures repeat per block, glTF has v pointing down where OBJ has t pointing up
+			pTexCoords[idx * 2] = static_cast<float>(GetTexCoordOffset(corners.texCoordIndices[corner], 0) * quad.size[cubeFace.sAxis]);
+			pTexCoords[idx * 2 + 1] = 1.f - static_cast<float>(GetTexCoordOffset(corners.texCoordIndices[corner], 1) * quad.size[cubeFace.tAxis]);
+		}
+	}
+
+	//Writes the header, the JSON chunk and the binary chunk of the layout, the quads are converted on the worker pool
+	//pOutput has to hold layout.fileSize bytes, glTF is little-endian like every platform this builds for
+	inline void WriteGlb(char* pOutput, const GlbLayout& layout, const std::vector<MeshQuad>& quads, const std::vector<GlbInstanceGroup>& instanceGroups, WorkerPool& workerPool)
+	{
+		auto writeUint32 = [](char* p, const uint32_t value) { memcpy(p, &value, sizeof(value)); };
+
+		writeUint32(pOutput, GLB_MAGIC);
+		writeUint32(pOutput + 4, 2);
+		writeUint32(pOutput + 8, static_cast<uint32_t>(layout.fileSize));
+
+		char* pJsonChunk{ pOutput + GLB_HEADER_SIZE };
+		writeUint32(pJsonChunk, static_cast<uint32_t>(layout.json.size()));
+		writeUint32(pJsonChunk + 4, GLB_JSON_CHUNK);
+		memcpy(pJsonChunk + GLB_CHUNK_HEADER_SIZE, layout.json.data(), layout.json.size());
+
+		if (layout.binSize == 0) return;
+
+		char* pBin{ pOutput + layout.binOffset };
+		writeUint32(pBin - GLB_CHUNK_HEADER_SIZE, static_cast<uint32_t>(layout.binSize));
+		writeUint32(pBin - 4, GLB_BIN_CHUNK);
+
+		const size_t vertexCount{ (layout.cubeQuadCount + quads.size()) * 4 };
+		float* pPositions{ reinterpret_cast<float*>(pBin) };
+		float* pNormals{ pPositions + vertexCount * 3 };
+		float* pTexCoords{ pNormals + vertexCount * 3 };
+		char* pIndices{ reinterpret_cast<char*>(pTexCoords + vertexCount * 2) };
+
+		//Zero the padding between index arrays
+		const size_t indexSize{ layout.translationsOffset - static_cast<size_t>(pIndices - pBin) };
+		memset(pIndices, 0, indexSize);
+
+		const std::vector<QuadCorners> quadCorners{ BuildQuadCorners() };
+
+		//Unit cube and instance translations
+		for (size_t face{ 0 }; face < layout.cubeQuadCount; ++face)
+		{
+			const MeshQuad cubeQuad{ { 0, 0, 0 }, { 1, 1, 1 }, 0, static_cast<uint8_t>(face) };
+			WriteGlbQuadVertices(cubeQuad, quadCorners[face], face * 4, pPositions, pNormals, pTexCoords);
+
+			for (int i{ 0 }; i < 6; ++i)
+			{
+				const uint16_t index{ static_cast<uint16_t>(face * 4 + quadCorners[face].triangles[i]) };
+				memcpy(pIndices + (face * 6 + i) * sizeof(uint16_t), &index, sizeof(index));
+			}
+		}
+
+		char* pTranslations{ pBin + layout.translationsOffset };
+		for (const GlbInstanceGroup& instanceGroup : instanceGroups)
+		{
+			const size_t translationsSize{ instanceGroup.translations.size() * sizeof(float) };
+			if (translationsSize != 0) memcpy(pTranslations, instanceGroup.translations.data(), translationsSize);
+			pTranslations += translationsSize;
+		}
+
+		const size_t rangeCount{ (layout.quadOrder.size() + GLB_RANGE_SIZE - 1) / GLB_RANGE_SIZE };
+
+		workerPool.ParallelFor(rangeCount, 1,
+			[&](const size_t begin, const size_t end, const int)
+			{
+				for (size_t rangeIdx{ begin }; rangeIdx < end; ++rangeIdx)
+				{
+					const size_t orderBegin{ rangeIdx * GLB_RANGE_SIZE };
+					const size_t orderEnd{ (std::min)(orderBegin + GLB_RANGE_SIZE, layout.quadOrder.size()) };
+
+					//Primitive of the first quad in the range
+					auto primitiveIt{ std::upper_bound(layout.primitives.begin(), layout.primitives.end(), orderBegin,
+						[](const size_t orderIdx, const GlbPrimitive& primitive) { return orderIdx < primitive.firstQuad; }) - 1 };
+
+					for (size_t orderIdx{ orderBegin }; orderIdx < orderEnd; ++orderIdx)
+					{
+						if (orderIdx >= primitiveIt->firstQuad + primitiveIt->quadCount) ++primitiveIt;
+
+						const MeshQuad& quad{ quads[layout.quadOrder[orderIdx]] };
+						const QuadCorners& corners{ quadCorners[quad.face] };
+
+						WriteGlbQuadVertices(quad, corners, (layout.cubeQuadCount + orderIdx) * 4, pPositions, pNormals, pTexCoords);
+
+						//Indices, relative to the first vertex of the primitive
+						const size_t primitiveQuadIdx{ orderIdx - primitiveIt->firstQuad };
+						const uint32_t firstIndex{ static_cast<uint32_t>(primitiveQuadIdx * 4) };
+						for (int i{ 0 }; i < 6; ++i)
+						{
+							const uint32_t index{ firstIndex + static_cast<uint32_t>(corners.triangles[i]) };
+							if (primitiveIt->hasShortIndices)
+							{
+								const uint16_t shortIndex{ static_cast<uint16_t>(index) };
+								memcpy(pIndices + primitiveIt->indexOffset + (primitiveQuadIdx * 6 + i) * sizeof(uint16_t), &shortIndex, sizeof(shortIndex));
+							}
+							else
+							{
+								memcpy(pIndices + primitiveIt->indexOffset + (primitiveQuadIdx * 6 + i) * sizeof(uint32_t), &index, sizeof(index));
+							}
+						}
+					}
+				}
+			}
+		);
+	}
+}
@@ -0,0 +1,226 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "rapidjson/reader.h"
+#include "rapidjson/memorystream.h"
+
+#include "CpuFeatures.h"
+
+namespace commonCode
+{
+	inline bool IsJsonWhitespace(const char c)
+	{
+		return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+	}
+
+	//Returns the first non-whitespace character in [p, end), or end
+	inline const char* SkipJsonWhitespaceScalar(const char* p, const char* end)
+	{
+		while (p != end && IsJsonWhitespace(*p)) ++p;
+		return p;
+	}
+
+#if defined(COMMONCODE_X86)
+	inline int CountTrailingZeros(const uint32_t mask)
+	{
+#if defined(_MSC_VER)
+		unsigned long idx{};
+		_BitScanForward(&idx, mask);
+		return static_cast<int>(idx);
+#else
+		return __builtin_ctz(mask);
+#endif
+	}
+
+	//16 characters per step, compared against each whitespace character
+	COMMONCODE_TARGET_SSE2 inline const char* SkipJsonWhitespaceSse2(const char* p, const char* end)
+	{
+		//Most whitespace runs are a single space or none at all
+		if (p == end || IsJsonWhitespace(*p) == false) return p;
+		++p;
+
+		const __m128i spaces{ _mm_set1_epi8(' ') };
+		const __m128i newLines{ _mm_set1_epi8('\n') };
+		const __m128i returns{ _mm_set1_epi8('\r') };
+		const __m128i tabs{ _mm_set1_epi8('\t') };
+
+		for (; end - p >= 16; p += 16)
+		{
+			const __m128i chars{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)) };
+			__m128i isWhitespace{ _mm_cmpeq_epi8(chars, spaces) };
+			isWhitespace = _mm_or_si128(isWhitespace, _mm_cmpeq_epi8(chars, newLines));
+			isWhitespace = _mm_or_si128(isWhitespace, _mm_cmpeq_epi8(chars, returns));
+			isWhitespace = _mm_or_si128(isWhitespace, _mm_cmpeq_epi8(chars, tabs));
+
+			const uint32_t otherMask{ ~static_cast<uint32_t>(_mm_movemask_epi8(isWhitespace)) & 0xFFFF };
+			if (otherMask != 0) return p + CountTrailingZeros(otherMask);
+		}
+
+		return SkipJsonWhitespaceScalar(p, end);
+	}
+
+	//16 characters per step, a single string compare finds the first character that isn't whitespace
+	COMMONCODE_TARGET_SSE42 inline const char* SkipJsonWhitespaceSse42(const char* p, const char* end)
+	{
+		if (p == end || IsJsonWhitespace(*p) == false) return p;
+		++p;
+
+		const __m128i whitespace{ _mm_setr_epi8(' ', '\n', '\r', '\t', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0) };
+
+		for (; end - p >= 16; p += 16)
+		{
+			const __m128i chars{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)) };
+			const int otherIdx{ _mm_cmpistri(whitespace, chars, _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_LEAST_SIGNIFICANT | _SIDD_NEGATIVE_POLARITY) };
+			if (otherIdx != 16) return p + otherIdx;
+		}
+
+		return SkipJsonWhitespaceScalar(p, end);
+	}
+
+	//32 characters per step, whitespace is found with a lookup on the low 4 bits of every character
+	COMMONCODE_TARGET_AVX2 inline const char* SkipJsonWhitespaceAvx2(const char* p, const char* end)
+	{
+		if (p == end || IsJsonWhitespace(*p) == false) return p;
+		++p;
+
+		//Characters with the high bit set look up 0 and never match
+		const __m256i whitespaceTable{ _mm256_setr_epi8(
+			' ', 0, 0, 0, 0, 0, 0, 0, 0, '\t', '\n', 0, 0, '\r', 0, 0,
+			' ', 0, 0, 0, 0, 0, 0, 0, 0, '\t', '\n', 0, 0, '\r', 0, 0
+		) };
+
+		for (; end - p >= 32; p += 32)
+		{
+			const __m256i chars{ _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)) };
+			const __m256i isWhitespace{ _mm256_cmpeq_epi8(_mm256_shuffle_epi8(whitespaceTable, chars), chars) };
+
+			const uint32_t otherMask{ ~static_cast<uint32_t>(_mm256_movemask_epi8(isWhitespace)) };
+			if (otherMask != 0) return p + CountTrailingZeros(otherMask);
+		}
+
+		return SkipJsonWhitespaceScalar(p, end);
+	}
+#endif
+
+	using SkipJsonWhitespaceFunc = const char*(*)(const char*, const char*);
+
+	//Picks the widest whitespace scanner the given level allows
+	inline SkipJsonWhitespaceFunc GetSkipJsonWhitespaceFunc(const SimdLevel simdLevel = GetSimdLevel())
+	{
+#if defined(COMMONCODE_X86)
+		switch (simdLevel)
+		{
+		case SimdLevel::AVX2: return &SkipJsonWhitespaceAvx2;
+		case SimdLevel::SSE42: return &SkipJsonWhitespaceSse42;
+		case SimdLevel::SSE2: return &SkipJsonWhitespaceSse2;
+		case SimdLevel::SCALAR:
+		default: break;
+		}
+#endif
+		return &SkipJsonWhitespaceScalar;
+	}
+
+	//Byte range of one or more consecutive JSON values
+	struct JsonRange
+	{
+		const char* pBegin;
+		const char* pEnd;
+	};
+
+	//Characters that open, close or separate values, and the two that matter inside strings
+	inline bool IsJsonStructural(const char c)
+	{
+		return c == '"' || c == '\\' || c == ',' || c == '[' || c == ']' || c == '{' || c == '}';
+	}
+
+	//Returns the first structural character in [p, end), or end
+	inline const char* FindJsonStructuralScalar(const char* p, const char* end)
+	{
+		while (p != end && IsJsonStructural(*p) == false) ++p;
+		return p;
+	}
+
+#if defined(COMMONCODE_X86)
+	//16 characters per step, compared against each structural character
+	COMMONCODE_TARGET_SSE2 inline const char* FindJsonStructuralSse2(const char* p, const char* end)
+	{
+		const __m128i structurals[]{
+			_mm_set1_epi8('"'), _mm_set1_epi8('\\'), _mm_set1_epi8(','),
+			_mm_set1_epi8('['), _mm_set1_epi8(']'), _mm_set1_epi8('{'), _mm_set1_epi8('}'),
+		};
+
+		for (; end - p >= 16; p += 16)
+		{
+			const __m128i chars{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)) };
+			__m128i isStructural{ _mm_setzero_si128() };
+			for (const __m128i& structural : structurals) isStructural = _mm_or_si128(isStructural, _mm_cmpeq_epi8(chars, structural));
+
+			const uint32_t structuralMask{ static_cast<uint32_t>(_mm_movemask_epi8(isStructural)) };
+			if (structuralMask != 0) return p + CountTrailingZeros(structuralMask);
+		}
+
+		return FindJsonStructuralScalar(p, end);
+	}
+
+	//Same as the SSE2 version, 32 characters per step
+	COMMONCODE_TARGET_AVX2 inline const char* FindJsonStructuralAvx2(const char* p, const char* end)
+	{
+		const __m256i structurals[]{
+			_mm256_set1_epi8('"'), _mm256_set1_epi8('\\'), _mm256_set1_epi8(','),
+			_mm256_set1_epi8('['), _mm256_set1_epi8(']'), _mm256_set1_epi8('{'), _mm256_set1_epi8('}'),
+		};
+
+		for (; end - p >= 32; p += 32)
+		{
+			const __m256i chars{ _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)) };
+			__m256i isStructural{ _mm256_setzero_si256() };
+			for (const __m256i& structural : structurals) isStructural = _mm256_or_si256(isStructural, _mm256_cmpeq_epi8(chars, structural));
+
+			const uint32_t structuralMask{ static_cast<uint32_t>(_mm256_movemask_epi8(isStructural)) };
+			if (structuralMask != 0) return p + CountTrailingZeros(structuralMask);
+		}
+
+		return FindJsonStructuralScalar(p, end);
+	}
+#endif
+
+	using FindJsonStructuralFunc = const char*(*)(const char*, const char*);
+
+	//Picks the widest structural character scanner the given level allows
+	inline FindJsonStructuralFunc GetFindJsonStructuralFunc(const SimdLevel simdLevel = GetSimdLevel())
+	{
+#if defined(COMMONCODE_X86)
+		switch (simdLevel)
+		{
+		case SimdLevel::AVX2: return &FindJsonStructuralAvx2;
+		case SimdLevel::SSE42:
+		case SimdLevel::SSE2: return &FindJsonStructuralSse2;
+		case SimdLevel::SCALAR:
+		default: break;
+		}
+#endif
+		return &FindJsonStructuralScalar;
+	}
+
+	//Memory stream that skips whitespace with a scanner picked at runtime
+	//rapidjson only has compile-time SIMD paths, which a header-only build can't tailor to the CPU it runs on
+	struct ScanMemoryStream : rapidjson::MemoryStream
+	{
+		ScanMemoryStream(const Ch* src, const size_t size, const SimdLevel simdLevel = GetSimdLevel())
+			: rapidjson::MemoryStream{ src, size }
+			, skipWhitespace{ GetSkipJsonWhitespaceFunc(simdLevel) }
+		{
+		}
+
+		SkipJsonWhitespaceFunc skipWhitespace;
+	};
+}
+
+RAPIDJSON_NAMESPACE_BEGIN
+//Used by the reader between all tokens
+template<> inline void SkipWhitespace(commonCode::ScanMemoryStream& is)
+{
+	is.src_ = is.skipWhitespace(is.src_, is.end_);
+}
+RAPIDJSON_NAMESPACE_END
@@ -0,0 +1,189 @@
+#pragma once
+#include <string>
+#include <cstring>
+
+#if defined(_WIN32)
+//winsock2.h has to be included before windows.h, so this header comes first
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <afunix.h>
+#else
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "MappedFile.h"
+
+namespace commonCode
+{
+	//Stream socket bound to a path on the local machine (AF_UNIX), Windows supports these since Windows 10 1803
+	//Messages are exchanged as lines, SendLine adds the \n that ReceiveLine strips
+	class LocalSocket
+	{
+	public:
+		LocalSocket() = default;
+
+		~LocalSocket()
+		{
+			Close();
+		}
+
+		LocalSocket(const LocalSocket&) = delete;
+		LocalSocket& operator=(const LocalSocket&) = delete;
+
+		//Replaces a socket file left behind by a daemon that didn't shut down
+		bool Listen(const std::wstring& path)
+		{
+			Close();
+
+			sockaddr_un address{};
+			if (Startup() == false || ToAddress(path, address) == false) return false;
+
+#if defined(_WIN32)
+			DeleteFileA(address.sun_path);
+#else
+			unlink(address.sun_path);
+#endif
+
+			m_Socket = socket(AF_UNIX, SOCK_STREAM, 0);
+			if (m_Socket == INVALID_SOCKET_HANDLE) return false;
+
+			if (bind(m_Socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || listen(m_Socket, SOMAXCONN) != 0)
+			{
+				Close();
+				return false;
+			}
+			return true;
+		}
+
+		//Blocks until a client connects
+		bool Accept(LocalSocket& client) const
+		{
+			client.Close();
+
+			client.m_Socket = accept(m_Socket, nullptr, nullptr);
+			return client.m_Socket != INVALID_SOCKET_HANDLE;
+		}
+
+		bool Connect(const std::wstring& path)
+		{
+			Close();
+
+			sockaddr_un address{};
+			if (Startup() == false || ToAddress(path, address) == false) return false;
+
+			m_Socket = socket(AF_UNIX, SOCK_STREAM, 0);
+			if (m_Socket == INVALID_SOCKET_HANDLE) return false;
+
+			if (connect(m_Socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+			{
+				Close();
+				return false;
+			}
+			return true;
+		}
+
+		void Close()
+		{
+			if (m_Socket != INVALID_SOCKET_HANDLE)
+			{
+#if defined(_WIN32)
+				closesocket(m_Socket);
+#else
+				close(m_Socket);
+#endif
+			}
+			m_Socket = INVALID_SOCKET_HANDLE;
+			m_Received.clear();
+		}
+
+		bool IsOpen() const { return m_Socket != INVALID_SOCKET_HANDLE; }
+
+		//line can't contain \n
+		bool SendLine(const std::string& line)
+		{
+			const std::string message{ line + "\n" };
+			for (size_t sent{ 0 }; sent < message.size();)
+			{
+				const int sentNow{ static_cast<int>(send(m_Socket, message.data() + sent, static_cast<int>(message.size() - sent), SEND_FLAGS)) };
+				if (sentNow <= 0) return false;
+				sent += static_cast<size_t>(sentNow);
+			}
+			return true;
+		}
+
+		//Returns false when the connection is closed before a whole line arrived
+		bool ReceiveLine(std::string& line)
+		{
+			while (true)
+			{
+				const size_t lineEnd{ m_Received.find('\n') };
+				if (lineEnd != std::string::npos)
+				{
+					line.assign(m_Received, 0, lineEnd);
+					m_Received.erase(0, lineEnd + 1);
+					return true;
+				}
+
+				char buffer[4096];
+				const int receivedNow{ static_cast<int>(recv(m_Socket, buffer, static_cast<int>(sizeof(buffer)), 0)) };
+				if (receivedNow <= 0) return false;
+				m_Received.append(buffer, static_cast<size_t>(receivedNow));
+			}
+		}
+
+	private:
+#if defined(_WIN32)
+		using SocketHandle = SOCKET;
+		static constexpr SocketHandle INVALID_SOCKET_HANDLE{ INVALID_SOCKET };
+		static constexpr int SEND_FLAGS{ 0 };
+#elif defined(MSG_NOSIGNAL)
+		using SocketHandle = int;
+		static constexpr SocketHandle INVALID_SOCKET_HANDLE{ -1 };
+		static constexpr int SEND_FLAGS{ MSG_NOSIGNAL }; //a client that went away must not end the daemon
+#else
+		using SocketHandle = int;
+		static constexpr SocketHandle INVALID_SOCKET_HANDLE{ -1 };
+		static constexpr int SEND_FLAGS{ 0 };
+#endif
+
+		SocketHandle m_Socket{ INVALID_SOCKET_HANDLE };
+		std::string m_Received{};
+
+		//Winsock has to be started once per process, it is cleaned up when the process exits
+		static bool Startup()
+		{
+#if defined(_WIN32)
+			static const bool isStarted{ []()
+				{
+					WSADATA wsaData{};
+					return WSAStartup(MAKEWORD(2, 2), &wsaData) == 0;
+				}()
+			};
+			return isStarted;
+#else
+			return true;
+#endif
+		}
+
+		static bool ToAddress(const std::wstring& path, sockaddr_un& address)
+		{
+			std::string pathStr{};
+#if defined(_WIN32)
+			const int pathLength{ WideCharToMultiByte(CP_ACP, 0, path.c_str(), static_cast<int>(path.size()), nullptr, 0, nullptr, nullptr) };
+			pathStr.assign(static_cast<size_t>(pathLength), '\0');
+			WideCharToMultiByte(CP_ACP, 0, path.c_str(), static_cast<int>(path.size()), &pathStr[0], pathLength, nullptr, nullptr);
+#else
+			if (ToMultiByteFilename(path, pathStr) == false) return false;
+#endif
+			if (pathStr.empty() || pathStr.size() >= sizeof(address.sun_path)) return false;
+
+			address.sun_family = AF_UNIX;
+			memcpy(address.sun_path, pathStr.c_str(), pathStr.size() + 1);
+			return true;
+		}
+	};
+}
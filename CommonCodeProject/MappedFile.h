@@ -0,0 +1,237 @@
+#pragma once
+#include <string>
+#include <cstddef>
+#include <cstdlib>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace commonCode
+{
+#if !defined(_WIN32)
+	//Converts a file name to a multibyte string for the POSIX file functions
+	inline bool ToMultiByteFilename(const std::wstring& filename, std::string& filenameStr)
+	{
+		filenameStr.assign(filename.length() * MB_CUR_MAX + 1, '\0');
+		const size_t filenameLen{ wcstombs(&filenameStr[0], filename.c_str(), filenameStr.size()) };
+		if (filenameLen == static_cast<size_t>(-1)) return false;
+
+		filenameStr.resize(filenameLen);
+		return true;
+	}
+#endif
+
+	//Read-only view of a whole file, the OS loads pages when they are first touched so nothing is copied up front
+	//Empty files can't be mapped and stay closed
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+		explicit MappedFile(const std::wstring& filename)
+		{
+			Open(filename);
+		}
+
+		~MappedFile()
+		{
+			Close();
+		}
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		bool Open(const std::wstring& filename)
+		{
+			Close();
+
+#if defined(_WIN32)
+			m_File = CreateFileW(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+			if (m_File == INVALID_HANDLE_VALUE) return false;
+
+			LARGE_INTEGER fileSize{};
+			if (GetFileSizeEx(m_File, &fileSize) == FALSE || fileSize.QuadPart <= 0)
+			{
+				Close();
+				return false;
+			}
+
+			m_Mapping = CreateFileMappingW(m_File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (m_Mapping == nullptr)
+			{
+				Close();
+				return false;
+			}
+
+			m_pData = static_cast<const char*>(MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0));
+			if (m_pData == nullptr)
+			{
+				Close();
+				return false;
+			}
+
+			m_Size = static_cast<size_t>(fileSize.QuadPart);
+#else
+			std::string filenameStr{};
+			if (ToMultiByteFilename(filename, filenameStr) == false) return false;
+
+			const int file{ open(filenameStr.c_str(), O_RDONLY) };
+			if (file == -1) return false;
+
+			struct stat fileInfo{};
+			if (fstat(file, &fileInfo) == 0 && fileInfo.st_size > 0)
+			{
+				void* pData{ mmap(nullptr, static_cast<size_t>(fileInfo.st_size), PROT_READ, MAP_PRIVATE, file, 0) };
+				if (pData != MAP_FAILED)
+				{
+					madvise(pData, static_cast<size_t>(fileInfo.st_size), MADV_SEQUENTIAL);
+					m_pData = static_cast<const char*>(pData);
+					m_Size = static_cast<size_t>(fileInfo.st_size);
+				}
+			}
+
+			close(file); //the mapping keeps its own reference
+#endif
+
+			return IsOpen();
+		}
+
+		void Close()
+		{
+#if defined(_WIN32)
+			if (m_pData != nullptr) UnmapViewOfFile(m_pData);
+			if (m_Mapping != nullptr) CloseHandle(m_Mapping);
+			if (m_File != INVALID_HANDLE_VALUE) CloseHandle(m_File);
+			m_Mapping = nullptr;
+			m_File = INVALID_HANDLE_VALUE;
+#else
+			if (m_pData != nullptr) munmap(const_cast<char*>(m_pData), m_Size);
+#endif
+			m_pData = nullptr;
+			m_Size = 0;
+		}
+
+		bool IsOpen() const { return m_pData != nullptr; }
+
+		const char* GetData() const { return m_pData; }
+		size_t GetSize() const { return m_Size; }
+
+	private:
+		const char* m_pData{ nullptr };
+		size_t m_Size{ 0 };
+
+#if defined(_WIN32)
+		HANDLE m_File{ INVALID_HANDLE_VALUE };
+		HANDLE m_Mapping{ nullptr };
+#endif
+	};
+
+	//Writable view of a new file that is created with its final size, so threads can fill separate parts of it at once
+	//Dirty pages go to disk through the page cache without another copy
+	class MappedOutputFile
+	{
+	public:
+		MappedOutputFile() = default;
+
+		~MappedOutputFile()
+		{
+			Close();
+		}
+
+		MappedOutputFile(const MappedOutputFile&) = delete;
+		MappedOutputFile& operator=(const MappedOutputFile&) = delete;
+
+		//Creates or truncates the file and sizes it, the contents are undefined until written
+		bool Create(const std::wstring& filename, const size_t size)
+		{
+			Close();
+			if (size == 0) return false;
+
+#if defined(_WIN32)
+			m_File = CreateFileW(filename.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (m_File == INVALID_HANDLE_VALUE) return false;
+
+			LARGE_INTEGER fileSize{};
+			fileSize.QuadPart = static_cast<LONGLONG>(size);
+			if (SetFilePointerEx(m_File, fileSize, nullptr, FILE_BEGIN) == FALSE || SetEndOfFile(m_File) == FALSE)
+			{
+				Close();
+				return false;
+			}
+
+			m_Mapping = CreateFileMappingW(m_File, nullptr, PAGE_READWRITE, fileSize.HighPart, fileSize.LowPart, nullptr);
+			if (m_Mapping == nullptr)
+			{
+				Close();
+				return false;
+			}
+
+			m_pData = static_cast<char*>(MapViewOfFile(m_Mapping, FILE_MAP_WRITE, 0, 0, 0));
+			if (m_pData == nullptr)
+			{
+				Close();
+				return false;
+			}
+#else
+			std::string filenameStr{};
+			if (ToMultiByteFilename(filename, filenameStr) == false) return false;
+
+			const int file{ open(filenameStr.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644) };
+			if (file == -1) return false;
+
+			if (ftruncate(file, static_cast<off_t>(size)) == 0)
+			{
+				void* pData{ mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0) };
+				if (pData != MAP_FAILED) m_pData = static_cast<char*>(pData);
+			}
+
+			close(file); //the mapping keeps its own reference
+			if (m_pData == nullptr) return false;
+#endif
+
+			m_Size = size;
+			return true;
+		}
+
+		//Returns false if the file couldn't be written back
+		bool Close()
+		{
+			bool isWritten{ true };
+
+#if defined(_WIN32)
+			if (m_pData != nullptr && UnmapViewOfFile(m_pData) == FALSE) isWritten = false;
+			if (m_Mapping != nullptr) CloseHandle(m_Mapping);
+			if (m_File != INVALID_HANDLE_VALUE && CloseHandle(m_File) == FALSE) isWritten = false;
+			m_Mapping = nullptr;
+			m_File = INVALID_HANDLE_VALUE;
+#else
+			if (m_pData != nullptr && munmap(m_pData, m_Size) != 0) isWritten = false;
+#endif
+			m_pData = nullptr;
+			m_Size = 0;
+			return isWritten;
+		}
+
+		bool IsOpen() const { return m_pData != nullptr; }
+
+		char* GetData() const { return m_pData; }
+		size_t GetSize() const { return m_Size; }
+
+	private:
+		char* m_pData{ nullptr };
+		size_t m_Size{ 0 };
+
+#if defined(_WIN32)
+		HANDLE m_File{ INVALID_HANDLE_VALUE };
+		HANDLE m_Mapping{ nullptr };
+#endif
+	};
+}
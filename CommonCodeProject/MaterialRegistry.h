@@ -0,0 +1,48 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+
+#include "VoxelGrid.h"
+
+namespace commonCode
+{
+	//Interned layer names, every distinct name gets a small material id in the order it is first registered
+	//Blocks store the id, names are only resolved when a material or report is written
+	class MaterialRegistry
+	{
+	public:
+		//Returns the id of the name, registering it when it is new
+		//Returns EMPTY_MATERIAL when every id is in use
+		uint16_t GetMaterialId(const std::wstring& name)
+		{
+			const auto materialIt{ m_MaterialIds.find(name) };
+			if (materialIt != m_MaterialIds.end()) return materialIt->second;
+
+			if (m_Names.size() >= EMPTY_MATERIAL) return EMPTY_MATERIAL;
+
+			const uint16_t materialId{ static_cast<uint16_t>(m_Names.size()) };
+			m_Names.push_back(name);
+			m_MaterialIds.emplace(name, materialId);
+			return materialId;
+		}
+
+		const std::wstring& GetName(const uint16_t materialId) const { return m_Names[materialId]; }
+
+		size_t GetCount() const { return m_Names.size(); }
+
+		//Names indexed by material id
+		const std::vector<std::wstring>& GetNames() const { return m_Names; }
+
+		void Clear()
+		{
+			m_Names.clear();
+			m_MaterialIds.clear();
+		}
+
+	private:
+		std::vector<std::wstring> m_Names{};
+		std::unordered_map<std::wstring, uint16_t> m_MaterialIds{};
+	};
+}
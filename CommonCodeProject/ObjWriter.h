@@ -0,0 +1,408 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+#include "rapidjson/internal/itoa.h"
+
+namespace commonCode
+{
+	//Encodes UTF-16 (Windows) or UTF-32 wide characters as UTF-8
+	inline std::string ToUtf8(const std::wstring& text)
+	{
+		std::string utf8Text{};
+		utf8Text.reserve(text.size());
+
+		for (size_t i{ 0 }; i < text.size(); ++i)
+		{
+			uint32_t codePoint{ static_cast<uint32_t>(text[i]) };
+
+			//Surrogate pair
+			if (codePoint >= 0xD800 && codePoint < 0xDC00 && i + 1 < text.size())
+			{
+				const uint32_t lowSurrogate{ static_cast<uint32_t>(text[i + 1]) };
+				if (lowSurrogate >= 0xDC00 && lowSurrogate < 0xE000)
+				{
+					codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (lowSurrogate - 0xDC00);
+					++i;
+				}
+			}
+
+			if (codePoint < 0x80)
+			{
+				utf8Text += static_cast<char>(codePoint);
+			}
+			else if (codePoint < 0x800)
+			{
+				utf8Text += static_cast<char>(0xC0 | (codePoint >> 6));
+				utf8Text += static_cast<char>(0x80 | (codePoint & 0x3F));
+			}
+			else if (codePoint < 0x10000)
+			{
+				utf8Text += static_cast<char>(0xE0 | (codePoint >> 12));
+				utf8Text += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+				utf8Text += static_cast<char>(0x80 | (codePoint & 0x3F));
+			}
+			else
+			{
+				utf8Text += static_cast<char>(0xF0 | (codePoint >> 18));
+				utf8Text += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+				utf8Text += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+				utf8Text += static_cast<char>(0x80 | (codePoint & 0x3F));
+			}
+		}
+
+		return utf8Text;
+	}
+
+	//Decodes UTF-8 into UTF-16 (Windows) or UTF-32 wide characters, invalid bytes are kept as they are
+	inline std::wstring FromUtf8(const std::string& utf8Text)
+	{
+		std::wstring text{};
+		text.reserve(utf8Text.size());
+
+		for (size_t i{ 0 }; i < utf8Text.size();)
+		{
+			const uint32_t lead{ static_cast<uint8_t>(utf8Text[i]) };
+			const size_t length{ (lead >= 0xF0) ? size_t{ 4 } : (lead >= 0xE0) ? size_t{ 3 } : (lead >= 0xC0) ? size_t{ 2 } : size_t{ 1 } };
+
+			if (length == 1 || i + length > utf8Text.size())
+			{
+				text += static_cast<wchar_t>(lead);
+				++i;
+				continue;
+			}
+
+			uint32_t codePoint{ lead & (0x7F >> length) };
+			for (size_t j{ 1 }; j < length; ++j)
+			{
+				codePoint = (codePoint << 6) | (static_cast<uint8_t>(utf8Text[i + j]) & 0x3F);
+			}
+			i += length;
+
+			//Surrogate pair
+			if (codePoint >= 0x10000 && sizeof(wchar_t) == 2)
+			{
+				codePoint -= 0x10000;
+				text += static_cast<wchar_t>(0xD800 + (codePoint >> 10));
+				text += static_cast<wchar_t>(0xDC00 + (codePoint & 0x3FF));
+			}
+			else
+			{
+				text += static_cast<wchar_t>(codePoint);
+			}
+		}
+
+		return text;
+	}
+
+	//Writes OBJ text as UTF-8 into a large buffer that is flushed to the file in blocks
+	//Without an open file the buffer grows instead, so text can be formatted on other threads and written later
+	//Numbers are formatted by hand, whole numbers never go through floating point formatting
+	class ObjWriter
+	{
+	public:
+		//Longest line the writer formats in one piece, a face with 9 indices is about 110 characters
+		static constexpr size_t MAX_LINE_SIZE{ 256 };
+		static constexpr size_t DEFAULT_BUFFER_SIZE{ 1 << 20 };
+
+		explicit ObjWriter(const size_t bufferSize = DEFAULT_BUFFER_SIZE)
+			: m_Buffer(bufferSize > MAX_LINE_SIZE ? bufferSize : MAX_LINE_SIZE)
+		{
+		}
+
+		~ObjWriter()
+		{
+			Close();
+		}
+
+		ObjWriter(const ObjWriter&) = delete;
+		ObjWriter& operator=(const ObjWriter&) = delete;
+
+		bool Open(const std::wstring& filename)
+		{
+			Close();
+
+			//Binary mode, the text is already UTF-8 and lines end in \n on every platform
+			_wfopen_s(&m_pFile, filename.c_str(), L"wb");
+			m_IsGood = m_pFile != nullptr;
+			m_WrittenSize = 0;
+			return m_IsGood;
+		}
+
+		//Returns false if any write failed since the file was opened
+		bool Close()
+		{
+			if (m_pFile == nullptr) return m_IsGood;
+
+			Flush();
+			if (fclose(m_pFile) != 0) m_IsGood = false;
+			m_pFile = nullptr;
+			return m_IsGood;
+		}
+
+		bool IsOpen() const { return m_pFile != nullptr; }
+
+		//Bytes passed to the file since it was opened
+		size_t GetWrittenSize() const { return m_WrittenSize; }
+
+		//Does nothing without an open file, the text stays in the buffer
+		void Flush()
+		{
+			if (m_Size == 0 || m_pFile == nullptr) return;
+
+			if (fwrite(m_Buffer.data(), 1, m_Size, m_pFile) != m_Size) m_IsGood = false;
+			m_WrittenSize += m_Size;
+			m_Size = 0;
+		}
+
+		//Buffered text, only complete when no file is open
+		const char* GetData() const { return m_Buffer.data(); }
+		size_t GetSize() const { return m_Size; }
+
+		//Drops the buffered text and keeps the memory
+		void Clear()
+		{
+			m_Size = 0;
+		}
+
+		void Write(const char* text, const size_t length)
+		{
+			if (m_pFile == nullptr) Reserve(length);
+
+			//Text larger than the buffer goes straight to the file
+			if (m_pFile != nullptr && length >= m_Buffer.size())
+			{
+				Flush();
+				if (fwrite(text, 1, length, m_pFile) != length) m_IsGood = false;
+				m_WrittenSize += length;
+				return;
+			}
+
+			//Long text is written in buffer sized pieces
+			for (size_t written{ 0 }; written < length;)
+			{
+				if (m_Size == m_Buffer.size()) Flush();
+
+				const size_t pieceSize{ (std::min)(length - written, m_Buffer.size() - m_Size) };
+				memcpy(m_Buffer.data() + m_Size, text + written, pieceSize);
+				m_Size += pieceSize;
+				written += pieceSize;
+			}
+		}
+
+		void Write(const char* text)
+		{
+			Write(text, strlen(text));
+		}
+
+		//Appends the text buffered by a writer without a file
+		void Write(const ObjWriter& text)
+		{
+			Write(text.GetData(), text.GetSize());
+		}
+
+		void Write(const std::wstring& text)
+		{
+			const std::string utf8Text{ ToUtf8(text) };
+			Write(utf8Text.data(), utf8Text.size());
+		}
+
+		//"v x y z", with the same 4 decimals as %.4f
+		void WriteVertex(const int x, const int y, const int z)
+		{
+			char* p{ BeginLine() };
+			*p++ = 'v';
+			p = FormatFixed(x, p);
+			p = FormatFixed(y, p);
+			p = FormatFixed(z, p);
+			EndLine(p);
+		}
+
+		void WriteVertex(const float x, const float y, const float z)
+		{
+			char* p{ BeginLine() };
+			*p++ = 'v';
+			p = FormatFixed(x, p);
+			p = FormatFixed(y, p);
+			p = FormatFixed(z, p);
+			EndLine(p);
+		}
+
+		void WriteTexCoord(const int s, const int t)
+		{
+			char* p{ BeginLine() };
+			*p++ = 'v';
+			*p++ = 't';
+			p = FormatFixed(s, p);
+			p = FormatFixed(t, p);
+			EndLine(p);
+		}
+
+		void WriteNormal(const int x, const int y, const int z)
+		{
+			char* p{ BeginLine() };
+			*p++ = 'v';
+			*p++ = 'n';
+			p = FormatFixed(x, p);
+			p = FormatFixed(y, p);
+			p = FormatFixed(z, p);
+			EndLine(p);
+		}
+
+		//"f v/vt/vn v/vt/vn v/vt/vn"
+		void WriteFace(const int v0, const int vt0, const int vn0, const int v1, const int vt1, const int vn1, const int v2, const int vt2, const int vn2)
+		{
+			char* p{ BeginLine() };
+			*p++ = 'f';
+			p = FormatFaceVertex(v0, vt0, vn0, p);
+			p = FormatFaceVertex(v1, vt1, vn1, p);
+			p = FormatFaceVertex(v2, vt2, vn2, p);
+			EndLine(p);
+		}
+
+		void WriteMaterial(const std::wstring& materialName)
+		{
+			Write("\nusemtl ");
+			Write(materialName);
+			Write("\n");
+		}
+
+	private:
+		std::vector<char> m_Buffer;
+		size_t m_Size{ 0 };
+		size_t m_WrittenSize{ 0 };
+		FILE* m_pFile{ nullptr };
+		bool m_IsGood{ false };
+
+		char* BeginLine()
+		{
+			if (m_Buffer.size() - m_Size < MAX_LINE_SIZE)
+			{
+				if (m_pFile != nullptr) Flush();
+				else Reserve(MAX_LINE_SIZE);
+			}
+			return m_Buffer.data() + m_Size;
+		}
+
+		//Grows the buffer so length more characters fit
+		void Reserve(const size_t length)
+		{
+			if (m_Buffer.size() - m_Size >= length) return;
+
+			m_Buffer.resize((std::max)(m_Buffer.size() * 2, m_Size + length));
+		}
+
+		void EndLine(char* p)
+		{
+			*p++ = '\n';
+			m_Size = static_cast<size_t>(p - m_Buffer.data());
+		}
+
+		static char* FormatFixed(const int value, char* p)
+		{
+			*p++ = ' ';
+			p = rapidjson::internal::i32toa(value, p);
+			memcpy(p, ".0000", 5);
+			return p + 5;
+		}
+
+		//Rounds to 4 decimals, values too large to scale fall back to printf
+		static char* FormatFixed(const float value, char* p)
+		{
+			if (std::fabs(value) >= 100000.f || std::isfinite(value) == false)
+			{
+				return p + snprintf(p, MAX_LINE_SIZE / 4, " %.4f", static_cast<double>(value));
+			}
+
+			const int64_t scaled{ std::llround(static_cast<double>(value) * 10000.0) };
+			const uint64_t magnitude{ static_cast<uint64_t>(scaled < 0 ? -scaled : scaled) };
+
+			*p++ = ' ';
+			if (std::signbit(value)) *p++ = '-';
+			p = rapidjson::internal::u32toa(static_cast<uint32_t>(magnitude / 10000), p);
+			*p++ = '.';
+
+			uint32_t fraction{ static_cast<uint32_t>(magnitude % 10000) };
+			for (int digit{ 3 }; digit >= 0; --digit)
+			{
+				p[digit] = static_cast<char>('0' + fraction % 10);
+				fraction /= 10;
+			}
+			return p + 4;
+		}
+
+		static char* FormatFaceVertex(const int v, const int vt, const int vn, char* p)
+		{
+			*p++ = ' ';
+			p = rapidjson::internal::i32toa(v, p);
+			*p++ = '/';
+			p = rapidjson::internal::i32toa(vt, p);
+			*p++ = '/';
+			return rapidjson::internal::i32toa(vn, p);
+		}
+	};
+
+	//Same interface as ObjWriter for whole number lines, but only adds up how many characters would be written
+	//Used to find where text goes in the output before it is formatted
+	class ObjSizeCounter
+	{
+	public:
+		size_t GetSize() const { return m_Size; }
+
+		void Write(const char* text) { m_Size += strlen(text); }
+		void Write(const std::wstring& text) { m_Size += ToUtf8(text).size(); }
+
+		void WriteVertex(const int x, const int y, const int z)
+		{
+			m_Size += 2 + GetFixedSize(x) + GetFixedSize(y) + GetFixedSize(z);
+		}
+
+		void WriteTexCoord(const int s, const int t)
+		{
+			m_Size += 3 + GetFixedSize(s) + GetFixedSize(t);
+		}
+
+		void WriteNormal(const int x, const int y, const int z)
+		{
+			m_Size += 3 + GetFixedSize(x) + GetFixedSize(y) + GetFixedSize(z);
+		}
+
+		void WriteFace(const int v0, const int vt0, const int vn0, const int v1, const int vt1, const int vn1, const int v2, const int vt2, const int vn2)
+		{
+			m_Size += 2 + GetFaceVertexSize(v0, vt0, vn0) + GetFaceVertexSize(v1, vt1, vn1) + GetFaceVertexSize(v2, vt2, vn2);
+		}
+
+		void WriteMaterial(const std::wstring& materialName)
+		{
+			m_Size += 9 + ToUtf8(materialName).size();
+		}
+
+	private:
+		size_t m_Size{ 0 };
+
+		static size_t GetIntSize(const int value)
+		{
+			uint32_t magnitude{ value < 0 ? 0u - static_cast<uint32_t>(value) : static_cast<uint32_t>(value) };
+			size_t size{ value < 0 ? size_t{ 2 } : size_t{ 1 } };
+			for (; magnitude >= 10; magnitude /= 10) ++size;
+			return size;
+		}
+
+		//" " + value + ".0000"
+		static size_t GetFixedSize(const int value)
+		{
+			return 6 + GetIntSize(value);
+		}
+
+		//" " + v + "/" + vt + "/" + vn
+		static size_t GetFaceVertexSize(const int v, const int vt, const int vn)
+		{
+			return 3 + GetIntSize(v) + GetIntSize(vt) + GetIntSize(vn);
+		}
+	};
+}
@@ -0,0 +1,523 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <iterator>
+
+#include "CpuFeatures.h"
+#include "WorkerPool.h"
+
+namespace commonCode
+{
+	enum class OpaqueNeighbourPos
+	{
+		FRONT, //x - 1
+		BACK, //x + 1
+		LEFT, //z - 1
+		RIGHT, //z + 1
+		TOP, //y + 1
+		BOTTOM, //y - 1
+	};
+
+	constexpr int NEIGHBOUR_COUNT{ 6 };
+	constexpr uint8_t ALL_FACES_MASK{ (1 << NEIGHBOUR_COUNT) - 1 };
+
+	inline uint8_t ToFaceBit(const OpaqueNeighbourPos neighbourPos)
+	{
+		return static_cast<uint8_t>(1 << static_cast<int>(neighbourPos));
+	}
+
+	//Integer block or chunk coordinates used as a hash key, every int value is kept so far apart coordinates never collide
+	struct CoordKey
+	{
+		int x;
+		int y;
+		int z;
+
+		bool operator==(const CoordKey& other) const
+		{
+			return x == other.x && y == other.y && z == other.z;
+		}
+	};
+
+	struct CoordKeyHash
+	{
+		size_t operator()(const CoordKey& key) const
+		{
+			//splitmix64 finalizer over x and y, z is mixed in before a second round
+			uint64_t hash{ static_cast<uint32_t>(key.x) | (static_cast<uint64_t>(static_cast<uint32_t>(key.y)) << 32) };
+			hash = Mix(hash) ^ static_cast<uint32_t>(key.z);
+			return static_cast<size_t>(Mix(hash));
+		}
+
+		static uint64_t Mix(uint64_t value)
+		{
+			value ^= value >> 30;
+			value *= 0xbf58476d1ce4e5b9ull;
+			value ^= value >> 27;
+			value *= 0x94d049bb133111ebull;
+			value ^= value >> 31;
+			return value;
+		}
+	};
+
+	//Open-addressing hash map from coordinates to an index
+	class CoordHashMap
+	{
+	public:
+		static constexpr uint32_t INVALID_INDEX{ ~0u };
+
+		explicit CoordHashMap(const size_t expectedCount = 0)
+		{
+			Rehash(expectedCount * 2);
+		}
+
+		uint32_t Find(const CoordKey& key) const
+		{
+			for (size_t slot{ CoordKeyHash{}(key) & m_Mask }; ; slot = (slot + 1) & m_Mask)
+			{
+				//Empty slots hold INVALID_INDEX, which is never stored as a value
+				if (m_Values[slot] == INVALID_INDEX) return INVALID_INDEX;
+				if (m_Keys[slot] == key) return m_Values[slot];
+			}
+		}
+
+		//Returns the index already stored for this key, or stores and returns the given one
+		uint32_t Insert(const CoordKey& key, const uint32_t value)
+		{
+			if ((m_Count + 1) * 2 > m_Keys.size()) Rehash(m_Keys.size() * 2);
+
+			for (size_t slot{ CoordKeyHash{}(key) & m_Mask }; ; slot = (slot + 1) & m_Mask)
+			{
+				if (m_Values[slot] == INVALID_INDEX)
+				{
+					m_Keys[slot] = key;
+					m_Values[slot] = value;
+					++m_Count;
+					return value;
+				}
+				if (m_Keys[slot] == key) return m_Values[slot];
+			}
+		}
+
+		size_t GetCount() const { return m_Count; }
+
+	private:
+		std::vector<CoordKey> m_Keys{};
+		std::vector<uint32_t> m_Values{};
+		size_t m_Mask{ 0 };
+		size_t m_Count{ 0 };
+
+		void Rehash(const size_t minCapacity)
+		{
+			size_t capacity{ 16 };
+			while (capacity < minCapacity) capacity <<= 1;
+
+			std::vector<CoordKey> oldKeys{ std::move(m_Keys) };
+			std::vector<uint32_t> oldValues{ std::move(m_Values) };
+
+			m_Keys.assign(capacity, CoordKey{});
+			m_Values.assign(capacity, INVALID_INDEX);
+			m_Mask = capacity - 1;
+			m_Count = 0;
+
+			for (size_t i{ 0 }; i < oldKeys.size(); ++i)
+			{
+				if (oldValues[i] != INVALID_INDEX) Insert(oldKeys[i], oldValues[i]);
+			}
+		}
+	};
+
+	constexpr int CHUNK_SHIFT{ 4 };
+	constexpr int CHUNK_SIZE{ 1 << CHUNK_SHIFT };
+	constexpr int CHUNK_MASK{ CHUNK_SIZE - 1 };
+	constexpr int CHUNK_ROWS{ CHUNK_SIZE * CHUNK_SIZE };
+	constexpr int CHUNK_CELLS{ CHUNK_ROWS * CHUNK_SIZE };
+	constexpr int PADDED_CHUNK_SIZE{ CHUNK_SIZE + 2 };
+
+	constexpr uint16_t EMPTY_MATERIAL{ 0xFFFF };
+
+	//16x16x16 cells, occupancy is stored as one 16-bit row along x for every (z, y)
+	struct VoxelChunk
+	{
+		int chunkX;
+		int chunkY;
+		int chunkZ;
+
+		uint16_t opaqueRows[CHUNK_SIZE][CHUNK_SIZE];
+		uint16_t filledRows[CHUNK_SIZE][CHUNK_SIZE];
+		uint16_t faceRows[NEIGHBOUR_COUNT][CHUNK_SIZE][CHUNK_SIZE];
+		uint16_t materials[CHUNK_CELLS];
+	};
+
+	//True when both chunks hold the same cells, their visible faces are not compared
+	inline bool HasSameCells(const VoxelChunk& chunk, const VoxelChunk& otherChunk)
+	{
+		return memcmp(chunk.opaqueRows, otherChunk.opaqueRows, sizeof(chunk.opaqueRows)) == 0
+			&& memcmp(chunk.filledRows, otherChunk.filledRows, sizeof(chunk.filledRows)) == 0
+			&& memcmp(chunk.materials, otherChunk.materials, sizeof(chunk.materials)) == 0;
+	}
+
+	//Solid cells of a chunk plus the bordering cells of its neighbours, in the layout the face kernels expect
+	//Solid is opaque for the opaque pass, and one transparent material for each transparent pass
+	struct ChunkCullInput
+	{
+		uint16_t solidRows[PADDED_CHUNK_SIZE][PADDED_CHUNK_SIZE]; //[z + 1][y + 1]
+		uint16_t frontRows[CHUNK_SIZE][CHUNK_SIZE]; //bit 0 set when the cell at x == -1 is solid
+		uint16_t backRows[CHUNK_SIZE][CHUNK_SIZE]; //bit 15 set when the cell at x == 16 is solid
+	};
+
+	//A face of a solid cell is visible when its neighbour in that direction is not solid
+	//Visible faces are added to faceRows so several passes can be combined
+	inline void CullChunkFacesScalar(const ChunkCullInput& input, uint16_t faceRows[NEIGHBOUR_COUNT][CHUNK_SIZE][CHUNK_SIZE])
+	{
+		for (int z{ 0 }; z < CHUNK_SIZE; ++z)
+		{
+			for (int y{ 0 }; y < CHUNK_SIZE; ++y)
+			{
+				const uint16_t row{ input.solidRows[z + 1][y + 1] };
+
+				const uint16_t neighbourRows[NEIGHBOUR_COUNT]{
+					static_cast<uint16_t>((row << 1) | input.frontRows[z][y]),
+					static_cast<uint16_t>((row >> 1) | input.backRows[z][y]),
+					input.solidRows[z][y + 1],
+					input.solidRows[z + 2][y + 1],
+					input.solidRows[z + 1][y + 2],
+					input.solidRows[z + 1][y],
+				};
+
+				for (int n{ 0 }; n < NEIGHBOUR_COUNT; ++n)
+				{
+					faceRows[n][z][y] |= static_cast<uint16_t>(row & ~neighbourRows[n]);
+				}
+			}
+		}
+	}
+
+#if defined(COMMONCODE_X86)
+	//Same as the scalar kernel, 8 rows (128 cells) per instruction
+	COMMONCODE_TARGET_SSE2 inline void CullChunkFacesSse2(const ChunkCullInput& input, uint16_t faceRows[NEIGHBOUR_COUNT][CHUNK_SIZE][CHUNK_SIZE])
+	{
+		constexpr int rowsPerRegister{ 8 };
+
+		for (int z{ 0 }; z < CHUNK_SIZE; ++z)
+		{
+			for (int y{ 0 }; y < CHUNK_SIZE; y += rowsPerRegister)
+			{
+				const __m128i rows{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(&input.solidRows[z + 1][y + 1])) };
+
+				const __m128i neighbourRows[NEIGHBOUR_COUNT]{
+					_mm_or_si128(_mm_slli_epi16(rows, 1), _mm_loadu_si128(reinterpret_cast<const __m128i*>(&input.frontRows[z][y]))),
+					_mm_or_si128(_mm_srli_epi16(rows, 1), _mm_loadu_si128(reinterpret_cast<const __m128i*>(&input.backRows[z][y]))),
+					_mm_loadu_si128(reinterpret_cast<const __m128i*>(&input.solidRows[z][y + 1])),
+					_mm_loadu_si128(reinterpret_cast<const __m128i*>(&input.solidRows[z + 2][y + 1])),
+					_mm_loadu_si128(reinterpret_cast<const __m128i*>(&input.solidRows[z + 1][y + 2])),
+					_mm_loadu_si128(reinterpret_cast<const __m128i*>(&input.solidRows[z + 1][y])),
+				};
+
+				for (int n{ 0 }; n < NEIGHBOUR_COUNT; ++n)
+				{
+					__m128i* pFaceRows{ reinterpret_cast<__m128i*>(&faceRows[n][z][y]) };
+					const __m128i visibleRows{ _mm_andnot_si128(neighbourRows[n], rows) };
+					_mm_storeu_si128(pFaceRows, _mm_or_si128(_mm_loadu_si128(pFaceRows), visibleRows));
+				}
+			}
+		}
+	}
+
+	//Same as the scalar kernel, a full z slice (256 cells) per instruction
+	COMMONCODE_TARGET_AVX2 inline void CullChunkFacesAvx2(const ChunkCullInput& input, uint16_t faceRows[NEIGHBOUR_COUNT][CHUNK_SIZE][CHUNK_SIZE])
+	{
+		for (int z{ 0 }; z < CHUNK_SIZE; ++z)
+		{
+			const __m256i rows{ _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&input.solidRows[z + 1][1])) };
+
+			const __m256i neighbourRows[NEIGHBOUR_COUNT]{
+				_mm256_or_si256(_mm256_slli_epi16(rows, 1), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&input.frontRows[z][0]))),
+				_mm256_or_si256(_mm256_srli_epi16(rows, 1), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&input.backRows[z][0]))),
+				_mm256_loadu_si256(reinterpret_cast<const __m256i*>(&input.solidRows[z][1])),
+				_mm256_loadu_si256(reinterpret_cast<const __m256i*>(&input.solidRows[z + 2][1])),
+				_mm256_loadu_si256(reinterpret_cast<const __m256i*>(&input.solidRows[z + 1][2])),
+				_mm256_loadu_si256(reinterpret_cast<const __m256i*>(&input.solidRows[z + 1][0])),
+			};
+
+			for (int n{ 0 }; n < NEIGHBOUR_COUNT; ++n)
+			{
+				__m256i* pFaceRows{ reinterpret_cast<__m256i*>(&faceRows[n][z][0]) };
+				const __m256i visibleRows{ _mm256_andnot_si256(neighbourRows[n], rows) };
+				_mm256_storeu_si256(pFaceRows, _mm256_or_si256(_mm256_loadu_si256(pFaceRows), visibleRows));
+			}
+		}
+	}
+#endif
+
+	using CullChunkFacesFunc = void(*)(const ChunkCullInput&, uint16_t[NEIGHBOUR_COUNT][CHUNK_SIZE][CHUNK_SIZE]);
+
+	//Picks the widest face culling kernel the CPU supports
+	inline CullChunkFacesFunc GetCullChunkFacesFunc(const SimdLevel simdLevel = GetSimdLevel())
+	{
+#if defined(COMMONCODE_X86)
+		switch (simdLevel)
+		{
+		case SimdLevel::AVX2: return &CullChunkFacesAvx2;
+		case SimdLevel::SSE42:
+		case SimdLevel::SSE2: return &CullChunkFacesSse2;
+		case SimdLevel::SCALAR:
+		default: break;
+		}
+#endif
+		return &CullChunkFacesScalar;
+	}
+
+	//Sparse set of dense chunks, only chunks containing blocks are allocated
+	class VoxelGrid
+	{
+	public:
+		explicit VoxelGrid(const size_t expectedBlockCount = 0)
+			: m_ChunkLookup{ expectedBlockCount / CHUNK_CELLS + 1 }
+		{
+		}
+
+		void SetBlock(const int x, const int y, const int z, const bool isOpaque, const uint16_t materialId)
+		{
+			VoxelChunk& chunk{ GetOrCreateChunk(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT, z >> CHUNK_SHIFT) };
+
+			const int localX{ x & CHUNK_MASK };
+			const int localY{ y & CHUNK_MASK };
+			const int localZ{ z & CHUNK_MASK };
+			const uint16_t bit{ static_cast<uint16_t>(1 << localX) };
+
+			chunk.filledRows[localZ][localY] |= bit;
+			if (isOpaque) chunk.opaqueRows[localZ][localY] |= bit;
+			chunk.materials[GetCellIdx(localX, localY, localZ)] = materialId;
+		}
+
+		//Computes the visible face rows of every chunk, must be called before GetVisibleFaces
+		//Opaque cells hide the faces of opaque neighbours, transparent cells only those of neighbours with the same material
+		//Chunks are independent so they are spread over the workers of the pool
+		//simdLevel picks the face kernel, it has to be supported by the CPU
+		void CullFaces(WorkerPool& workerPool, const SimdLevel simdLevel = GetSimdLevel())
+		{
+			CullChunks(workerPool, m_Chunks.size(), [](const size_t i) { return i; }, simdLevel);
+		}
+
+		//Culls only the chunks at the given indices, the visible faces of the other chunks are left as they are
+		void CullFaces(WorkerPool& workerPool, const std::vector<uint32_t>& chunkIndices, const SimdLevel simdLevel = GetSimdLevel())
+		{
+			CullChunks(workerPool, chunkIndices.size(), [&chunkIndices](const size_t i) { return static_cast<size_t>(chunkIndices[i]); }, simdLevel);
+		}
+
+		//Returns a mask of ToFaceBit values for the faces of the cell that are not hidden
+		uint8_t GetVisibleFaces(const int x, const int y, const int z) const
+		{
+			const VoxelChunk* pChunk{ FindChunk(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT, z >> CHUNK_SHIFT) };
+			if (pChunk == nullptr) return 0;
+
+			const int localX{ x & CHUNK_MASK };
+			const int localY{ y & CHUNK_MASK };
+			const int localZ{ z & CHUNK_MASK };
+
+			uint8_t visibleFaces{ 0 };
+			for (int n{ 0 }; n < NEIGHBOUR_COUNT; ++n)
+			{
+				visibleFaces |= static_cast<uint8_t>(((pChunk->faceRows[n][localZ][localY] >> localX) & 1) << n);
+			}
+			return visibleFaces;
+		}
+
+		bool IsOpaque(const int x, const int y, const int z) const
+		{
+			const VoxelChunk* pChunk{ FindChunk(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT, z >> CHUNK_SHIFT) };
+			if (pChunk == nullptr) return false;
+
+			return ((pChunk->opaqueRows[z & CHUNK_MASK][y & CHUNK_MASK] >> (x & CHUNK_MASK)) & 1) != 0;
+		}
+
+		uint16_t GetMaterial(const int x, const int y, const int z) const
+		{
+			const VoxelChunk* pChunk{ FindChunk(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT, z >> CHUNK_SHIFT) };
+			if (pChunk == nullptr) return EMPTY_MATERIAL;
+
+			return pChunk->materials[GetCellIdx(x & CHUNK_MASK, y & CHUNK_MASK, z & CHUNK_MASK)];
+		}
+
+		const std::vector<VoxelChunk>& GetChunks() const { return m_Chunks; }
+
+		//Index in GetChunks, or CoordHashMap::INVALID_INDEX when the chunk holds no blocks
+		uint32_t FindChunkIdx(const int chunkX, const int chunkY, const int chunkZ) const
+		{
+			return m_ChunkLookup.Find(CoordKey{ chunkX, chunkY, chunkZ });
+		}
+
+	private:
+		std::vector<VoxelChunk> m_Chunks{};
+		CoordHashMap m_ChunkLookup;
+
+		//getChunkIdx(i) gives the index of the i-th chunk to cull
+		template<typename ChunkIdxFunc>
+		void CullChunks(WorkerPool& workerPool, const size_t count, const ChunkIdxFunc& getChunkIdx, const SimdLevel simdLevel)
+		{
+			constexpr size_t chunksPerTask{ 16 };
+
+			const CullChunkFacesFunc cullChunkFaces{ GetCullChunkFacesFunc(simdLevel) };
+			std::vector<ChunkCullInput> inputs(workerPool.GetThreadCount());
+
+			workerPool.ParallelFor(count, chunksPerTask,
+				[this, cullChunkFaces, &getChunkIdx, &inputs](const size_t begin, const size_t end, const int threadIdx)
+				{
+					ChunkCullInput& input{ inputs[threadIdx] };
+					std::vector<uint16_t> transparentMaterials{};
+
+					for (size_t i{ begin }; i < end; ++i)
+					{
+						COMMONCODE_TRACE_SCOPE("cull chunk", "chunk", static_cast<int64_t>(getChunkIdx(i)));
+						VoxelChunk& chunk{ m_Chunks[getChunkIdx(i)] };
+						std::fill(&chunk.faceRows[0][0][0], &chunk.faceRows[0][0][0] + NEIGHBOUR_COUNT * CHUNK_ROWS, uint16_t{ 0 });
+
+						//Opaque pass
+						GatherCullInput(chunk, input,
+							[](const VoxelChunk& rowChunk, const int z, const int y)
+							{
+								return rowChunk.opaqueRows[z][y];
+							}
+						);
+						cullChunkFaces(input, chunk.faceRows);
+
+						//One pass per transparent material
+						GetTransparentMaterials(chunk, transparentMaterials);
+						for (const uint16_t materialId : transparentMaterials)
+						{
+							GatherCullInput(chunk, input,
+								[materialId](const VoxelChunk& rowChunk, const int z, const int y)
+								{
+									return GetTransparentRow(rowChunk, z, y, materialId);
+								}
+							);
+							cullChunkFaces(input, chunk.faceRows);
+						}
+					}
+				}
+			);
+		}
+
+		static int GetCellIdx(const int localX, const int localY, const int localZ)
+		{
+			return (localZ * CHUNK_SIZE + localY) * CHUNK_SIZE + localX;
+		}
+
+		const VoxelChunk* FindChunk(const int chunkX, const int chunkY, const int chunkZ) const
+		{
+			const uint32_t chunkIdx{ m_ChunkLookup.Find(CoordKey{ chunkX, chunkY, chunkZ }) };
+			return (chunkIdx != CoordHashMap::INVALID_INDEX) ? &m_Chunks[chunkIdx] : nullptr;
+		}
+
+		VoxelChunk& GetOrCreateChunk(const int chunkX, const int chunkY, const int chunkZ)
+		{
+			const uint32_t newIdx{ static_cast<uint32_t>(m_Chunks.size()) };
+			const uint32_t chunkIdx{ m_ChunkLookup.Insert(CoordKey{ chunkX, chunkY, chunkZ }, newIdx) };
+
+			if (chunkIdx == newIdx)
+			{
+				m_Chunks.emplace_back();
+
+				VoxelChunk& chunk{ m_Chunks.back() };
+				chunk = VoxelChunk{};
+				chunk.chunkX = chunkX;
+				chunk.chunkY = chunkY;
+				chunk.chunkZ = chunkZ;
+				std::fill(std::begin(chunk.materials), std::end(chunk.materials), EMPTY_MATERIAL);
+			}
+
+			return m_Chunks[chunkIdx];
+		}
+
+		//Bits of the transparent cells in a row that have the given material
+		static uint16_t GetTransparentRow(const VoxelChunk& chunk, const int z, const int y, const uint16_t materialId)
+		{
+			const uint16_t transparentRow{ static_cast<uint16_t>(chunk.filledRows[z][y] & ~chunk.opaqueRows[z][y]) };
+			if (transparentRow == 0) return 0;
+
+			const uint16_t* pMaterials{ &chunk.materials[GetCellIdx(0, y, z)] };
+			uint16_t row{ 0 };
+			for (int x{ 0 }; x < CHUNK_SIZE; ++x)
+			{
+				if (((transparentRow >> x) & 1) && pMaterials[x] == materialId) row |= static_cast<uint16_t>(1 << x);
+			}
+			return row;
+		}
+
+		static void GetTransparentMaterials(const VoxelChunk& chunk, std::vector<uint16_t>& materialIds)
+		{
+			materialIds.clear();
+
+			for (int z{ 0 }; z < CHUNK_SIZE; ++z)
+			{
+				for (int y{ 0 }; y < CHUNK_SIZE; ++y)
+				{
+					const uint16_t transparentRow{ static_cast<uint16_t>(chunk.filledRows[z][y] & ~chunk.opaqueRows[z][y]) };
+					if (transparentRow == 0) continue;
+
+					for (int x{ 0 }; x < CHUNK_SIZE; ++x)
+					{
+						const uint16_t materialId{ chunk.materials[GetCellIdx(x, y, z)] };
+						if (((transparentRow >> x) & 1) && std::find(materialIds.begin(), materialIds.end(), materialId) == materialIds.end())
+						{
+							materialIds.push_back(materialId);
+						}
+					}
+				}
+			}
+		}
+
+		//getRow(chunk, z, y) returns the solid cells of a row for this pass
+		template<typename RowFunc>
+		void GatherCullInput(const VoxelChunk& chunk, ChunkCullInput& input, const RowFunc& getRow) const
+		{
+			input = ChunkCullInput{};
+
+			//Own cells
+			for (int z{ 0 }; z < CHUNK_SIZE; ++z)
+			{
+				for (int y{ 0 }; y < CHUNK_SIZE; ++y)
+				{
+					input.solidRows[z + 1][y + 1] = getRow(chunk, z, y);
+				}
+			}
+
+			//Cells of neighbouring chunks that touch this chunk
+			if (const VoxelChunk* pFront{ FindChunk(chunk.chunkX - 1, chunk.chunkY, chunk.chunkZ) })
+			{
+				for (int z{ 0 }; z < CHUNK_SIZE; ++z)
+					for (int y{ 0 }; y < CHUNK_SIZE; ++y)
+						input.frontRows[z][y] = static_cast<uint16_t>(getRow(*pFront, z, y) >> CHUNK_MASK);
+			}
+			if (const VoxelChunk* pBack{ FindChunk(chunk.chunkX + 1, chunk.chunkY, chunk.chunkZ) })
+			{
+				for (int z{ 0 }; z < CHUNK_SIZE; ++z)
+					for (int y{ 0 }; y < CHUNK_SIZE; ++y)
+						input.backRows[z][y] = static_cast<uint16_t>((getRow(*pBack, z, y) & 1) << CHUNK_MASK);
+			}
+			if (const VoxelChunk* pBottom{ FindChunk(chunk.chunkX, chunk.chunkY - 1, chunk.chunkZ) })
+			{
+				for (int z{ 0 }; z < CHUNK_SIZE; ++z)
+					input.solidRows[z + 1][0] = getRow(*pBottom, z, CHUNK_MASK);
+			}
+			if (const VoxelChunk* pTop{ FindChunk(chunk.chunkX, chunk.chunkY + 1, chunk.chunkZ) })
+			{
+				for (int z{ 0 }; z < CHUNK_SIZE; ++z)
+					input.solidRows[z + 1][PADDED_CHUNK_SIZE - 1] = getRow(*pTop, z, 0);
+			}
+			if (const VoxelChunk* pLeft{ FindChunk(chunk.chunkX, chunk.chunkY, chunk.chunkZ - 1) })
+			{
+				for (int y{ 0 }; y < CHUNK_SIZE; ++y)
+					input.solidRows[0][y + 1] = getRow(*pLeft, CHUNK_MASK, y);
+			}
+			if (const VoxelChunk* pRight{ FindChunk(chunk.chunkX, chunk.chunkY, chunk.chunkZ + 1) })
+			{
+				for (int y{ 0 }; y < CHUNK_SIZE; ++y)
+					input.solidRows[PADDED_CHUNK_SIZE - 1][y + 1] = getRow(*pRight, 0, y);
+			}
+		}
+	};
+}
@@ -0,0 +1,134 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <algorithm>
+#include <cstdint>
+
+#include "ConversionTrace.h"
+
+namespace commonCode
+{
+	//Fixed set of threads that split index ranges between them, the calling thread also takes part
+	//Jobs are not nestable, a task must not call ParallelFor on the pool that runs it
+	class WorkerPool
+	{
+	public:
+		using RangeTask = std::function<void(size_t begin, size_t end, int threadIdx)>;
+
+		explicit WorkerPool(const int threadCount = 1)
+		{
+			for (int threadIdx{ 1 }; threadIdx < threadCount; ++threadIdx)
+			{
+				m_Workers.emplace_back([this, threadIdx]() { WorkerLoop(threadIdx); });
+			}
+		}
+
+		~WorkerPool()
+		{
+			{
+				std::lock_guard<std::mutex> lock{ m_Mutex };
+				m_IsStopping = true;
+			}
+			m_JobStarted.notify_all();
+
+			for (std::thread& worker : m_Workers) worker.join();
+		}
+
+		WorkerPool(const WorkerPool&) = delete;
+		WorkerPool& operator=(const WorkerPool&) = delete;
+
+		int GetThreadCount() const { return static_cast<int>(m_Workers.size()) + 1; }
+
+		//Calls task for consecutive ranges of at most grainSize indices in [0, count) and waits until all are done
+		//threadIdx is in [0, GetThreadCount()) and can be used to pick per-thread scratch data
+		void ParallelFor(const size_t count, const size_t grainSize, const RangeTask& task)
+		{
+			if (count == 0) return;
+
+			if (m_Workers.empty() || count <= grainSize)
+			{
+				task(0, count, 0);
+				return;
+			}
+
+			std::lock_guard<std::mutex> jobLock{ m_JobMutex };
+			{
+				std::lock_guard<std::mutex> lock{ m_Mutex };
+#if defined(COMMONCODE_TRACE)
+				//Ranges are traced under the name of the span that started the job
+				const char* pSpanName{ TraceRecorder::GetCurrentSpanName() };
+				m_pJobName = (pSpanName != nullptr) ? pSpanName : "ParallelFor";
+#endif
+				m_pTask = &task;
+				m_Count = count;
+				m_GrainSize = (std::max)(grainSize, size_t{ 1 });
+				m_NextIdx = 0;
+				m_ActiveWorkers = m_Workers.size();
+				++m_JobId;
+			}
+			m_JobStarted.notify_all();
+
+			RunRanges(0);
+
+			std::unique_lock<std::mutex> lock{ m_Mutex };
+			m_JobFinished.wait(lock, [this]() { return m_ActiveWorkers == 0; });
+			m_pTask = nullptr;
+		}
+
+	private:
+		std::vector<std::thread> m_Workers{};
+
+		std::mutex m_JobMutex{};
+		std::mutex m_Mutex{};
+		std::condition_variable m_JobStarted{};
+		std::condition_variable m_JobFinished{};
+
+		const RangeTask* m_pTask{ nullptr };
+		size_t m_Count{ 0 };
+		size_t m_GrainSize{ 1 };
+		std::atomic<size_t> m_NextIdx{ 0 };
+		size_t m_ActiveWorkers{ 0 };
+		uint64_t m_JobId{ 0 };
+		bool m_IsStopping{ false };
+#if defined(COMMONCODE_TRACE)
+		const char* m_pJobName{ nullptr };
+#endif
+
+		void WorkerLoop(const int threadIdx)
+		{
+			uint64_t lastJobId{ 0 };
+			COMMONCODE_TRACE_THREAD("worker", threadIdx);
+
+			while (true)
+			{
+				{
+					std::unique_lock<std::mutex> lock{ m_Mutex };
+					m_JobStarted.wait(lock, [this, lastJobId]() { return m_IsStopping || m_JobId != lastJobId; });
+					if (m_IsStopping) return;
+					lastJobId = m_JobId;
+				}
+
+				RunRanges(threadIdx);
+
+				{
+					std::lock_guard<std::mutex> lock{ m_Mutex };
+					--m_ActiveWorkers;
+				}
+				m_JobFinished.notify_one();
+			}
+		}
+
+		void RunRanges(const int threadIdx)
+		{
+			for (size_t begin{ m_NextIdx.fetch_add(m_GrainSize) }; begin < m_Count; begin = m_NextIdx.fetch_add(m_GrainSize))
+			{
+				COMMONCODE_TRACE_SCOPE(m_pJobName, "begin", static_cast<int64_t>(begin), "end", static_cast<int64_t>((std::min)(begin + m_GrainSize, m_Count)));
+				(*m_pTask)(begin, (std::min)(begin + m_GrainSize, m_Count), threadIdx);
+			}
+		}
+	};
+}
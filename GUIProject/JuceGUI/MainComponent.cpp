@@ -197,9 +197,10 @@ void MainComponent::ConvertFile()
     outputPath.append(m_OutputExtenstion, m_OutputExtenstion.length());
 
     //Handle file conversion
-    std::vector<commonCode::Block> blocks{};
+    commonCode::BlockList blocks{};
+    commonCode::MaterialRegistry materials{};
     std::wstring conversionMsg{ L"" };
-    commonCode::ConvertJsonToObj(std::wstring{ m_InputFile.getFullPathName().toWideCharPointer() }, std::wstring{ outputPath.toWideCharPointer() }, blocks, conversionMsg);
+    commonCode::ConvertJsonToObj(std::wstring{ m_InputFile.getFullPathName().toWideCharPointer() }, std::wstring{ outputPath.toWideCharPointer() }, blocks, materials, conversionMsg);
 
     m_ConversionMsg = juce::String{ conversionMsg.c_str() };
     repaint();
@@ -210,7 +211,13 @@ void MainComponent::ConvertFile()
     case commonCode::ReportStatus::BLOCKS: //Report blocks
     {
         //Set report data
-        static_cast<TableModel*>(m_DataTable.getModel())->SetData(blocks);
+        std::vector<commonCode::Block> blocksData{};
+        blocksData.reserve(blocks.GetCount());
+        for (size_t i{ 0 }; i < blocks.GetCount(); ++i)
+        {
+            blocksData.push_back(blocks.GetBlock(i));
+        }
+        static_cast<TableModel*>(m_DataTable.getModel())->SetData(blocksData, materials);
 
         //Setup data table columns
         m_DataTable.getHeader().removeAllColumns();
@@ -230,27 +237,25 @@ void MainComponent::ConvertFile()
     case commonCode::ReportStatus::LAYERS: //Report layers
     {
         //Set report data
-        std::map<const std::wstring, int> layersData{};
-        for (const commonCode::Block& b : blocks)
+        std::vector<int> blockCounts(materials.GetCount());
+        for (const uint16_t materialId : blocks.GetMaterialIds())
+        {
+            ++blockCounts[materialId];
+        }
+
+        //Sort layers by name
+        std::map<const std::wstring, uint16_t> layersData{};
+        for (uint16_t materialId{ 0 }; materialId < materials.GetCount(); ++materialId)
         {
-            const std::wstring layername{ b.layerName };
-
-            if (layersData.find(layername) != layersData.end())
-            {
-                ++layersData[layername];
-            }
-            else
-            {
-                layersData[layername] = 1;
-            }
+            if (blockCounts[materialId] > 0) layersData[materials.GetName(materialId)] = materialId;
         }
         
         std::vector<commonCode::Block> layers{};
         for (const auto& layerIt : layersData)
         {
-            layers.push_back(commonCode::Block{ layerIt.first, false, commonCode::Vector3f{ layerIt.second, 0, 0 } });
+            layers.push_back(commonCode::Block{ layerIt.second, false, commonCode::Vector3f{ blockCounts[layerIt.second], 0, 0 } });
         }
-        static_cast<TableModel*>(m_DataTable.getModel())->SetData(layers);
+        static_cast<TableModel*>(m_DataTable.getModel())->SetData(layers, materials);
 
         //Setup data table columns
         m_DataTable.getHeader().removeAllColumns();
@@ -35,7 +35,7 @@ void TableModel::paintCell(Graphics& g, int rowNumber, int columnId, int width,
 		{
 		case 1:
 		{
-			g.drawText(String{ block.layerName.c_str() }, 0, 0, width - 10, height, Justification::centredLeft);
+			g.drawText(String{ m_Materials.GetName(block.materialId).c_str() }, 0, 0, width - 10, height, Justification::centredLeft);
 			break;
 		}
 
@@ -21,13 +21,16 @@ public:
 		bool 	rowIsSelected
 	) override;
 
-	void SetData(const std::vector<commonCode::Block>& data)
+	void SetData(const std::vector<commonCode::Block>& data, const commonCode::MaterialRegistry& materials)
 	{
 		m_Data.clear();
 		for (const commonCode::Block& block : data)
 			m_Data.push_back(block);
+
+		m_Materials = materials;
 	}
 
 private:
 	std::vector<commonCode::Block> m_Data;
+	commonCode::MaterialRegistry m_Materials;
 };
@@ -0,0 +1,176 @@
+#include <map>
+#include <tuple>
+#include <random>
+#include <algorithm>
+
+#include "CommonCode.h"
+
+using BlockPosition = std::tuple<int, int, int>;
+
+//Layer of the generated scene, the file order of the layers gives the material ids of a read
+struct Layer
+{
+	std::wstring name;
+	bool isOpaque;
+};
+
+//Builds the grid the way UpdateWatchedObj does, blocks in file order with the material ids of the session
+commonCode::VoxelGrid BuildGrid(const std::map<BlockPosition, size_t>& scene, const std::vector<Layer>& layers, const std::vector<size_t>& fileOrder, commonCode::MaterialRegistry& materials)
+{
+	commonCode::BlockList blocks{};
+	commonCode::MaterialRegistry fileMaterials{};
+	for (const size_t layerIdx : fileOrder)
+	{
+		const uint16_t fileMaterialId{ fileMaterials.GetMaterialId(layers[layerIdx].name) };
+		for (const std::pair<const BlockPosition, size_t>& block : scene)
+		{
+			if (block.second != layerIdx) continue;
+			blocks.Add(std::get<0>(block.first), std::get<1>(block.first), std::get<2>(block.first), fileMaterialId, layers[layerIdx].isOpaque);
+		}
+	}
+
+	std::vector<uint16_t> materialIds(fileMaterials.GetCount());
+	for (size_t i{ 0 }; i < materialIds.size(); ++i)
+	{
+		materialIds[i] = materials.GetMaterialId(fileMaterials.GetName(static_cast<uint16_t>(i)));
+	}
+
+	commonCode::VoxelGrid grid{ blocks.GetCount() };
+	for (size_t i{ 0 }; i < blocks.GetCount(); ++i)
+	{
+		grid.SetBlock(blocks.GetX(i), blocks.GetY(i), blocks.GetZ(i), blocks.IsOpaque(i), materialIds[blocks.GetMaterialId(i)]);
+	}
+	return grid;
+}
+
+//Coordinate on either side of a chunk border, negative borders included
+int MakeBorderCoord(std::mt19937& random, const int chunkRadius)
+{
+	std::uniform_int_distribution<int> borderDistribution{ -chunkRadius, chunkRadius };
+	std::uniform_int_distribution<int> sideDistribution{ -1, 0 };
+	return borderDistribution(random) * commonCode::CHUNK_SIZE + sideDistribution(random);
+}
+
+//Applies random edits to a scene and updates one cache after every edit, its text has to equal the text
+//of a fresh cache given the same grid, so chunks that had to be meshed again never keep their old text
+//Edits on chunk borders change the border faces of the neighbours, removed chunks change the faces around them
+//and reordered layers change the material ids of a read but not the ids of the session
+int main()
+{
+	constexpr int stepCount{ 60 };
+	constexpr int chunkRadius{ 2 };
+	constexpr int sceneRadius{ chunkRadius * commonCode::CHUNK_SIZE };
+
+	std::mt19937 random{ 20240619 };
+	std::uniform_int_distribution<int> coordDistribution{ -sceneRadius, sceneRadius - 1 };
+	std::uniform_int_distribution<int> editDistribution{ 0, 4 };
+	std::uniform_int_distribution<int> countDistribution{ 1, 40 };
+
+	std::vector<Layer> layers{ Layer{ L"stone", true }, Layer{ L"dirt", true }, Layer{ L"glass", false }, Layer{ L"water", false }, Layer{ L"leaves", false } };
+	std::vector<size_t> fileOrder{ 0, 1, 2 }; //layers 3 and 4 come up in later reads
+	std::map<BlockPosition, size_t> scene{};
+	auto randomLayer = [&]() { return fileOrder[std::uniform_int_distribution<size_t>{ 0, fileOrder.size() - 1 }(random)]; };
+
+	for (int i{ 0 }; i < 6000; ++i)
+	{
+		scene[std::make_tuple(coordDistribution(random), coordDistribution(random), coordDistribution(random))] = randomLayer();
+	}
+
+	commonCode::WorkerPool workerPool{ 4 };
+	commonCode::MaterialRegistry materials{};
+	commonCode::ChunkMeshCache cache{};
+	size_t partialUpdateCount{ 0 };
+	int failedCount{ 0 };
+
+	for (int stepIdx{ 0 }; stepIdx < stepCount; ++stepIdx)
+	{
+		const int edit{ editDistribution(random) };
+		if (stepIdx == 0)
+		{
+			//First read meshes every chunk
+		}
+		else if (edit == 0)
+		{
+			//Blocks added and removed on chunk borders
+			const int count{ countDistribution(random) };
+			for (int i{ 0 }; i < count; ++i)
+			{
+				const BlockPosition position{ MakeBorderCoord(random, chunkRadius), coordDistribution(random), coordDistribution(random) };
+				const BlockPosition rotatedPosition{ std::get<1>(position), std::get<2>(position), std::get<0>(position) };
+				for (const BlockPosition& borderPosition : { position, rotatedPosition })
+				{
+					if (scene.erase(borderPosition) == 0) scene[borderPosition] = randomLayer();
+				}
+			}
+		}
+		else if (edit == 1)
+		{
+			//Every block of a chunk removed
+			const int chunkX{ coordDistribution(random) >> commonCode::CHUNK_SHIFT };
+			const int chunkY{ coordDistribution(random) >> commonCode::CHUNK_SHIFT };
+			const int chunkZ{ coordDistribution(random) >> commonCode::CHUNK_SHIFT };
+			for (auto blockIt{ scene.begin() }; blockIt != scene.end();)
+			{
+				const bool isInChunk{ (std::get<0>(blockIt->first) >> commonCode::CHUNK_SHIFT) == chunkX
+					&& (std::get<1>(blockIt->first) >> commonCode::CHUNK_SHIFT) == chunkY && (std::get<2>(blockIt->first) >> commonCode::CHUNK_SHIFT) == chunkZ };
+				blockIt = isInChunk ? scene.erase(blockIt) : std::next(blockIt);
+			}
+		}
+		else if (edit == 2)
+		{
+			//Blocks moved to another layer
+			const int count{ countDistribution(random) };
+			for (int i{ 0 }; i < count; ++i)
+			{
+				const auto blockIt{ scene.lower_bound(std::make_tuple(coordDistribution(random), coordDistribution(random), coordDistribution(random))) };
+				if (blockIt != scene.end()) blockIt->second = randomLayer();
+			}
+		}
+		else if (edit == 3)
+		{
+			//Layers reordered, sometimes with a layer the session hasn't seen yet
+			if (fileOrder.size() < layers.size() && countDistribution(random) < 20) fileOrder.push_back(fileOrder.size());
+			std::shuffle(fileOrder.begin(), fileOrder.end(), random);
+		}
+		//else the same scene is read again
+
+		//Greedy and unit quads take turns now and then, which meshes every chunk again
+		const bool mergeFaces{ (stepIdx / 10) % 2 == 1 };
+
+		const size_t meshedChunkCount{ cache.Update(BuildGrid(scene, layers, fileOrder, materials), mergeFaces, workerPool) };
+		if (meshedChunkCount < cache.GetChunkCount()) ++partialUpdateCount;
+
+		commonCode::ChunkMeshCache freshCache{};
+		freshCache.Update(BuildGrid(scene, layers, fileOrder, materials), mergeFaces, workerPool);
+
+		commonCode::ObjWriter writer{};
+		cache.Write(writer, materials.GetNames());
+		commonCode::ObjWriter freshWriter{};
+		freshCache.Write(freshWriter, materials.GetNames());
+
+		if (writer.GetSize() != freshWriter.GetSize() || memcmp(writer.GetData(), freshWriter.GetData(), writer.GetSize()) != 0)
+		{
+			wprintf_s(
+				L"Step %d, edit %d: %d bytes written after meshing %d of %d chunks, a fresh cache writes %d bytes\n",
+				stepIdx, edit, static_cast<int>(writer.GetSize()), static_cast<int>(meshedChunkCount), static_cast<int>(cache.GetChunkCount()), static_cast<int>(freshWriter.GetSize())
+			);
+			++failedCount;
+		}
+	}
+
+	//Most updates have to keep chunks, otherwise the test would pass on a cache that meshes everything
+	if (partialUpdateCount < stepCount / 2)
+	{
+		wprintf_s(L"Only %d of %d updates kept chunks\n", static_cast<int>(partialUpdateCount), stepCount);
+		++failedCount;
+	}
+
+	if (failedCount > 0)
+	{
+		wprintf_s(L"%d updates write other text than a fresh cache!\n", failedCount);
+		return -1;
+	}
+
+	wprintf_s(L"Every update of the cache writes the text of a fresh cache\n");
+	return 0;
+}
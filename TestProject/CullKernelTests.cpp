@@ -0,0 +1,84 @@
+#include <set>
+#include <tuple>
+#include <random>
+
+#include "CommonCode.h"
+
+//Culls random scenes with every face kernel the CPU supports and checks the visible faces of every opaque block
+//against the neighbours CheckOpaqueNeighbours finds, transparent blocks are mixed in since they must not hide opaque faces
+int main()
+{
+	constexpr int sceneCount{ 20 };
+	constexpr int sceneRadius{ 24 }; //blocks of both signs, so chunk borders on negative coordinates are covered too
+
+	const commonCode::SimdLevel simdLevels[]{ commonCode::SimdLevel::SCALAR, commonCode::SimdLevel::SSE2, commonCode::SimdLevel::SSE42, commonCode::SimdLevel::AVX2 };
+
+	std::mt19937 random{ 20240601 };
+	std::uniform_int_distribution<int> coordDistribution{ -sceneRadius, sceneRadius - 1 };
+	std::uniform_int_distribution<int> typeDistribution{ 0, 3 };
+
+	commonCode::WorkerPool workerPool{ 4 };
+	int failedCount{ 0 };
+
+	for (int sceneIdx{ 0 }; sceneIdx < sceneCount; ++sceneIdx)
+	{
+		//Denser scenes hide more faces
+		commonCode::BlockList blocks{};
+		std::set<std::tuple<int, int, int>> positions{};
+		const int blockCount{ 1000 + sceneIdx * 2000 };
+		for (int i{ 0 }; i < blockCount; ++i)
+		{
+			const int x{ coordDistribution(random) };
+			const int y{ coordDistribution(random) };
+			const int z{ coordDistribution(random) };
+			if (positions.insert(std::make_tuple(x, y, z)).second == false) continue;
+
+			const bool isOpaque{ typeDistribution(random) != 0 };
+			blocks.Add(x, y, z, isOpaque ? 0 : 1, isOpaque);
+		}
+
+		const commonCode::OpaqueBlockIndex opaqueBlocks{ blocks };
+
+		for (const commonCode::SimdLevel simdLevel : simdLevels)
+		{
+			if (simdLevel > commonCode::GetSimdLevel()) continue;
+
+			commonCode::VoxelGrid grid{ blocks.GetCount() };
+			for (size_t i{ 0 }; i < blocks.GetCount(); ++i)
+			{
+				grid.SetBlock(blocks.GetX(i), blocks.GetY(i), blocks.GetZ(i), blocks.IsOpaque(i), blocks.GetMaterialId(i));
+			}
+			grid.CullFaces(workerPool, simdLevel);
+
+			for (size_t i{ 0 }; i < blocks.GetCount(); ++i)
+			{
+				if (blocks.IsOpaque(i) == false) continue;
+
+				uint8_t expectedFaces{ commonCode::ALL_FACES_MASK };
+				for (const commonCode::OpaqueNeighbourPos neighbourPos : commonCode::CheckOpaqueNeighbours(blocks.GetBlock(i), opaqueBlocks))
+				{
+					expectedFaces &= static_cast<uint8_t>(~commonCode::ToFaceBit(neighbourPos));
+				}
+
+				const uint8_t visibleFaces{ grid.GetVisibleFaces(blocks.GetX(i), blocks.GetY(i), blocks.GetZ(i)) };
+				if (visibleFaces != expectedFaces)
+				{
+					wprintf_s(
+						L"%s kernel: block at %d, %d, %d has visible faces %d instead of %d\n",
+						commonCode::ToString(simdLevel), blocks.GetX(i), blocks.GetY(i), blocks.GetZ(i), static_cast<int>(visibleFaces), static_cast<int>(expectedFaces)
+					);
+					++failedCount;
+				}
+			}
+		}
+	}
+
+	if (failedCount > 0)
+	{
+		wprintf_s(L"%d blocks have wrong visible faces!\n", failedCount);
+		return -1;
+	}
+
+	wprintf_s(L"Every face kernel matches CheckOpaqueNeighbours\n");
+	return 0;
+}
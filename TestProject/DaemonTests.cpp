@@ -0,0 +1,73 @@
+//The command line tool is compiled in without its entry point, so the daemon and its client run in this process
+#define COMMANDLINETOOL_NO_MAIN
+#include "../CommandLineProject/CommandLineTool.cpp"
+
+//Starts a daemon on a temporary socket, keeps one client connected without sending a job
+//and converts a scene through SubmitJobs on a second connection, which must not wait for the first one
+int main()
+{
+	wchar_t tempPath[MAX_PATH];
+	if (GetTempPathW(MAX_PATH, tempPath) == 0)
+	{
+		wprintf_s(L"Failed to find the temporary directory!\n");
+		return -1;
+	}
+
+	const std::wstring tempDirectory{ tempPath };
+	const std::wstring socketPath{ tempDirectory + L"minecraftToolDaemonTest.sock" };
+	const std::wstring inputFilename{ tempDirectory + L"minecraftToolDaemonTest.json" };
+	const std::wstring outputFilename{ tempDirectory + L"minecraftToolDaemonTest.obj" }; //default output of the job
+
+	//Write a small scene
+	{
+		const std::string scene{ "[{\"layer\": \"stone\", \"opaque\": true, \"positions\": [[0, 0, 0], [0, 0, 1], [1, 0, 0]]}]" };
+		commonCode::ObjWriter inputFile{};
+		if (inputFile.Open(inputFilename) == false)
+		{
+			wprintf_s(L"Failed to create %s!\n", inputFilename.c_str());
+			return -1;
+		}
+		inputFile.Write(scene.c_str(), scene.size());
+		if (inputFile.Close() == false)
+		{
+			wprintf_s(L"Failed to write %s!\n", inputFilename.c_str());
+			return -1;
+		}
+	}
+	_wremove(outputFilename.c_str());
+
+	//The daemon never returns while it is listening, it ends with the process
+	const commonCode::ConversionSettings settings{};
+	std::thread{ [socketPath, settings]() { RunDaemon(socketPath, settings); } }.detach();
+
+	//The idle client also waits for the daemon to listen
+	commonCode::LocalSocket idleClient{};
+	for (int tryIdx{ 0 }; tryIdx < 100 && idleClient.Connect(socketPath) == false; ++tryIdx)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds{ 50 });
+	}
+	if (idleClient.IsOpen() == false)
+	{
+		wprintf_s(L"The daemon doesn't listen on %s!\n", socketPath.c_str());
+		return -1;
+	}
+
+	const std::vector<commonCode::DaemonJob> jobs{ commonCode::DaemonJob{ inputFilename, L"", L"obj", L"" } };
+	if (SubmitJobs(socketPath, jobs) != 0)
+	{
+		wprintf_s(L"The daemon failed to convert %s!\n", inputFilename.c_str());
+		return -1;
+	}
+
+	//Check the output starts like every .obj output
+	const std::string header{ "#Minecraft Scene\n" };
+	commonCode::MappedFile outputFile{};
+	if (outputFile.Open(outputFilename) == false || outputFile.GetSize() <= header.size() || memcmp(outputFile.GetData(), header.c_str(), header.size()) != 0)
+	{
+		wprintf_s(L"The daemon didn't write %s!\n", outputFilename.c_str());
+		return -1;
+	}
+
+	wprintf_s(L"The daemon converted a job while another client was connected\n");
+	return 0;
+}
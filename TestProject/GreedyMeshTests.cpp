@@ -0,0 +1,231 @@
+#include <map>
+#include <set>
+#include <tuple>
+#include <random>
+#include <sstream>
+
+#include "CommonCode.h"
+
+//Unit face of a block: direction, material and block coordinates
+using UnitFace = std::tuple<int, int, int, int, int>;
+
+//Writes the quads as .obj text and checks the two faces of every quad use texture coordinates scaled by the quad size
+//and vertices that span the quad, returns the number of quads that don't
+int CheckQuadMesh(const std::vector<commonCode::MeshQuad>& quads, const bool weldVertices, const int sceneIdx)
+{
+	const std::vector<std::wstring> layerNames{ L"Layer0", L"Layer1", L"Layer2", L"Layer3" };
+	commonCode::ConversionStats stats{};
+	commonCode::ObjWriter writer{};
+	commonCode::WriteQuadMesh(writer, quads, layerNames, weldVertices, stats);
+
+	//The 4 unit texture coordinates come from the header of the file
+	std::vector<std::pair<double, double>> texCoords{ { 0.0, 0.0 }, { 1.0, 0.0 }, { 0.0, 1.0 }, { 1.0, 1.0 } };
+	std::vector<std::vector<double>> vertices{};
+	std::vector<std::vector<int>> faces{}; //vertex and texture coordinate index of the 3 corners
+
+	std::istringstream text{ std::string{ writer.GetData(), writer.GetSize() } };
+	std::string line{};
+	while (std::getline(text, line))
+	{
+		std::istringstream lineStream{ line };
+		std::string type{};
+		lineStream >> type;
+		if (type.compare("vt") == 0)
+		{
+			std::pair<double, double> texCoord{};
+			lineStream >> texCoord.first >> texCoord.second;
+			texCoords.push_back(texCoord);
+		}
+		else if (type.compare("v") == 0)
+		{
+			std::vector<double> vertex(3);
+			lineStream >> vertex[0] >> vertex[1] >> vertex[2];
+			vertices.push_back(vertex);
+		}
+		else if (type.compare("f") == 0)
+		{
+			std::vector<int> face{};
+			std::string corner{};
+			while (lineStream >> corner)
+			{
+				face.push_back(std::stoi(corner));
+				face.push_back(std::stoi(corner.substr(corner.find('/') + 1)));
+			}
+			faces.push_back(face);
+		}
+	}
+
+	if (faces.size() != quads.size() * 2)
+	{
+		wprintf_s(L"Scene %d: %d faces written for %d quads\n", sceneIdx, static_cast<int>(faces.size()), static_cast<int>(quads.size()));
+		return 1;
+	}
+
+	int failedCount{ 0 };
+	for (size_t quadIdx{ 0 }; quadIdx < quads.size(); ++quadIdx)
+	{
+		const commonCode::MeshQuad& quad{ quads[quadIdx] };
+		const commonCode::CubeFace& cubeFace{ commonCode::CUBE_FACES[quad.face] };
+
+		double texCoordMax[2]{ 0.0, 0.0 };
+		double vertexMin[3]{ 1e9, 1e9, 1e9 };
+		double vertexMax[3]{ -1e9, -1e9, -1e9 };
+		bool isValid{ true };
+		for (size_t faceIdx{ quadIdx * 2 }; faceIdx < quadIdx * 2 + 2; ++faceIdx)
+		{
+			const std::vector<int>& face{ faces[faceIdx] };
+			for (size_t i{ 0 }; i + 1 < face.size(); i += 2)
+			{
+				if (face[i] < 1 || face[i] > static_cast<int>(vertices.size()) || face[i + 1] < 1 || face[i + 1] > static_cast<int>(texCoords.size()))
+				{
+					isValid = false;
+					continue;
+				}
+
+				const std::pair<double, double>& texCoord{ texCoords[face[i + 1] - 1] };
+				texCoordMax[0] = (std::max)(texCoordMax[0], texCoord.first);
+				texCoordMax[1] = (std::max)(texCoordMax[1], texCoord.second);
+
+				const std::vector<double>& vertex{ vertices[face[i] - 1] };
+				for (int axis{ 0 }; axis < 3; ++axis)
+				{
+					vertexMin[axis] = (std::min)(vertexMin[axis], vertex[axis]);
+					vertexMax[axis] = (std::max)(vertexMax[axis], vertex[axis]);
+				}
+			}
+		}
+
+		for (const int axis : { cubeFace.sAxis, cubeFace.tAxis })
+		{
+			if (vertexMin[axis] != quad.pos[axis] || vertexMax[axis] != quad.pos[axis] + quad.size[axis]) isValid = false;
+		}
+		if (texCoordMax[0] != quad.size[cubeFace.sAxis] || texCoordMax[1] != quad.size[cubeFace.tAxis]) isValid = false;
+
+		if (isValid == false)
+		{
+			wprintf_s(
+				L"Scene %d: %s quad at %d, %d, %d with size %d, %d, %d is written wrong\n",
+				sceneIdx, weldVertices ? L"welded" : L"separate", quad.pos[0], quad.pos[1], quad.pos[2], quad.size[0], quad.size[1], quad.size[2]
+			);
+			++failedCount;
+		}
+	}
+	return failedCount;
+}
+
+//Merges random scenes greedily and checks the quads of every direction and material cover exactly the unit faces
+//BuildBlockQuads emits for the same grid, every unit face once, so merged quads neither overlap nor leave gaps
+int main()
+{
+	constexpr int sceneCount{ 20 };
+	constexpr int sceneRadius{ 20 }; //blocks of both signs, so merges across negative chunk borders are covered too
+
+	std::mt19937 random{ 20240607 };
+	std::uniform_int_distribution<int> coordDistribution{ -sceneRadius, sceneRadius - 1 };
+	std::uniform_int_distribution<int> materialDistribution{ 0, 3 };
+
+	commonCode::WorkerPool workerPool{ 4 };
+	int failedCount{ 0 };
+
+	for (int sceneIdx{ 0 }; sceneIdx < sceneCount; ++sceneIdx)
+	{
+		//Layers 0 and 1 are opaque, 2 and 3 transparent, few layers and dense scenes give long merges
+		commonCode::BlockList blocks{};
+		std::set<std::tuple<int, int, int>> positions{};
+		const int blockCount{ 2000 + sceneIdx * 1500 };
+		for (int i{ 0 }; i < blockCount; ++i)
+		{
+			const int x{ coordDistribution(random) };
+			const int y{ coordDistribution(random) };
+			const int z{ coordDistribution(random) };
+			if (positions.insert(std::make_tuple(x, y, z)).second == false) continue;
+
+			const int materialId{ materialDistribution(random) };
+			blocks.Add(x, y, z, static_cast<uint16_t>(materialId), materialId < 2);
+		}
+
+		commonCode::VoxelGrid grid{ blocks.GetCount() };
+		commonCode::BuildVoxelGrid(blocks, grid, workerPool);
+
+		const std::vector<commonCode::MeshQuad> unitQuads{ commonCode::BuildBlockQuads(blocks, commonCode::GetVisibleBlockFaces(blocks, grid, workerPool)) };
+		std::set<UnitFace> unitFaces{};
+		for (const commonCode::MeshQuad& quad : unitQuads)
+		{
+			unitFaces.insert(std::make_tuple(static_cast<int>(quad.face), static_cast<int>(quad.materialId), quad.pos[0], quad.pos[1], quad.pos[2]));
+		}
+
+		//Count how often the merged quads cover every unit face
+		const std::vector<commonCode::MeshQuad> greedyQuads{ commonCode::BuildGreedyQuads(grid, workerPool) };
+		std::map<UnitFace, int> coveredFaces{};
+		for (const commonCode::MeshQuad& quad : greedyQuads)
+		{
+			const commonCode::CubeFace& cubeFace{ commonCode::CUBE_FACES[quad.face] };
+			if (quad.size[cubeFace.normalAxis] != 1 || quad.size[cubeFace.sAxis] < 1 || quad.size[cubeFace.tAxis] < 1)
+			{
+				wprintf_s(L"Scene %d: quad at %d, %d, %d has size %d, %d, %d\n", sceneIdx, quad.pos[0], quad.pos[1], quad.pos[2], quad.size[0], quad.size[1], quad.size[2]);
+				++failedCount;
+				continue;
+			}
+
+			for (int z{ 0 }; z < quad.size[2]; ++z)
+			{
+				for (int y{ 0 }; y < quad.size[1]; ++y)
+				{
+					for (int x{ 0 }; x < quad.size[0]; ++x)
+					{
+						++coveredFaces[std::make_tuple(static_cast<int>(quad.face), static_cast<int>(quad.materialId), quad.pos[0] + x, quad.pos[1] + y, quad.pos[2] + z)];
+					}
+				}
+			}
+		}
+
+		for (const std::pair<const UnitFace, int>& coveredFace : coveredFaces)
+		{
+			const UnitFace& face{ coveredFace.first };
+			if (coveredFace.second > 1 || unitFaces.count(face) == 0)
+			{
+				wprintf_s(
+					L"Scene %d: face %d of material %d at %d, %d, %d is covered %d times but %s visible\n",
+					sceneIdx, std::get<0>(face), std::get<1>(face), std::get<2>(face), std::get<3>(face), std::get<4>(face), coveredFace.second,
+					(unitFaces.count(face) == 0) ? L"isn't" : L"is"
+				);
+				++failedCount;
+			}
+		}
+
+		for (const UnitFace& face : unitFaces)
+		{
+			if (coveredFaces.count(face) == 0)
+			{
+				wprintf_s(
+					L"Scene %d: face %d of material %d at %d, %d, %d isn't covered by a quad\n",
+					sceneIdx, std::get<0>(face), std::get<1>(face), std::get<2>(face), std::get<3>(face), std::get<4>(face)
+				);
+				++failedCount;
+			}
+		}
+
+		//Parsing the text back is slow, a few scenes cover every quad size already
+		if (sceneIdx % 5 == 0)
+		{
+			failedCount += CheckQuadMesh(greedyQuads, false, sceneIdx);
+			failedCount += CheckQuadMesh(greedyQuads, true, sceneIdx);
+		}
+
+		//Dense scenes have to merge, otherwise the test would pass on unit quads alone
+		if (greedyQuads.size() >= unitQuads.size())
+		{
+			wprintf_s(L"Scene %d: %d quads for %d faces, nothing was merged\n", sceneIdx, static_cast<int>(greedyQuads.size()), static_cast<int>(unitQuads.size()));
+			++failedCount;
+		}
+	}
+
+	if (failedCount > 0)
+	{
+		wprintf_s(L"%d greedy meshing errors!\n", failedCount);
+		return -1;
+	}
+
+	wprintf_s(L"Greedy quads cover every visible face exactly once and are written with their size\n");
+	return 0;
+}
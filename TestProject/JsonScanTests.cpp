@@ -0,0 +1,84 @@
+#include <cstdio>
+#include <vector>
+#include <random>
+
+#include "JsonScan.h"
+
+//Compares the JSON scanners of every level the CPU supports with the scalar ones, for every start offset and every length
+//from 0 to 64 in random buffers, so the steps of 16 and 32 characters and the scalar tails all end on every position
+int main()
+{
+	constexpr int bufferCount{ 400 };
+	constexpr int maxOffset{ 64 };
+	constexpr int maxLength{ 64 };
+
+	const commonCode::SimdLevel simdLevels[]{ commonCode::SimdLevel::SCALAR, commonCode::SimdLevel::SSE2, commonCode::SimdLevel::SSE42, commonCode::SimdLevel::AVX2 };
+
+	//NUL ends the implicit length compare of SSE4.2, bytes with the high bit set look up 0 in the AVX2 table
+	//and ) - 0 * and the high bit bytes share the low 4 bits of a whitespace character
+	const char otherChars[]{
+		'\0', '\x80', '\x89', '\x8A', '\x8D', '\xA0', '\xC3', '\xFF', ')', '-', '0', '*', '\x0B', '\x0C', 'a', ':', '.',
+		'"', '\\', ',', '[', ']', '{', '}'
+	};
+	const char whitespaceChars[]{ ' ', '\n', '\r', '\t' };
+	const char plainChars[]{ '0', '-', '.', 'e', ' ', ':', '\0', '\xFF', '\x80' }; //neither structural nor rare in positions arrays
+	const double fillChances[]{ 0.0, 0.5, 0.9, 0.98, 1.0 }; //chance of a character the scanner goes past, long runs reach the vector steps
+
+	std::mt19937 random{ 20240611 };
+	std::uniform_int_distribution<size_t> otherDistribution{ 0, sizeof(otherChars) - 1 };
+	std::uniform_int_distribution<size_t> whitespaceDistribution{ 0, sizeof(whitespaceChars) - 1 };
+	std::uniform_int_distribution<size_t> plainDistribution{ 0, sizeof(plainChars) - 1 };
+	std::uniform_real_distribution<double> chanceDistribution{ 0.0, 1.0 };
+
+	int failedCount{ 0 };
+	std::vector<char> buffer(maxOffset + maxLength);
+
+	for (int bufferIdx{ 0 }; bufferIdx < bufferCount; ++bufferIdx)
+	{
+		const bool isWhitespaceTest{ bufferIdx % 2 == 0 };
+		const double fillChance{ fillChances[(bufferIdx / 2) % (sizeof(fillChances) / sizeof(fillChances[0]))] };
+		for (char& c : buffer)
+		{
+			if (chanceDistribution(random) < fillChance) c = isWhitespaceTest ? whitespaceChars[whitespaceDistribution(random)] : plainChars[plainDistribution(random)];
+			else c = otherChars[otherDistribution(random)];
+		}
+
+		for (const commonCode::SimdLevel simdLevel : simdLevels)
+		{
+			if (simdLevel > commonCode::GetSimdLevel()) continue;
+
+			const commonCode::SkipJsonWhitespaceFunc skipJsonWhitespace{ commonCode::GetSkipJsonWhitespaceFunc(simdLevel) };
+			const commonCode::FindJsonStructuralFunc findJsonStructural{ commonCode::GetFindJsonStructuralFunc(simdLevel) };
+
+			for (int offset{ 0 }; offset < maxOffset; ++offset)
+			{
+				for (int length{ 0 }; length <= maxLength; ++length)
+				{
+					const char* p{ buffer.data() + offset };
+					const char* end{ p + length };
+
+					const char* pExpected{ isWhitespaceTest ? commonCode::SkipJsonWhitespaceScalar(p, end) : commonCode::FindJsonStructuralScalar(p, end) };
+					const char* pFound{ isWhitespaceTest ? skipJsonWhitespace(p, end) : findJsonStructural(p, end) };
+					if (pFound != pExpected)
+					{
+						wprintf_s(
+							L"%s %s: buffer %d, offset %d, length %d stops at %d instead of %d\n",
+							commonCode::ToString(simdLevel), isWhitespaceTest ? L"whitespace skip" : L"structural search",
+							bufferIdx, offset, length, static_cast<int>(pFound - p), static_cast<int>(pExpected - p)
+						);
+						++failedCount;
+					}
+				}
+			}
+		}
+	}
+
+	if (failedCount > 0)
+	{
+		wprintf_s(L"%d scans stop at the wrong character!\n", failedCount);
+		return -1;
+	}
+
+	wprintf_s(L"Every JSON scanner matches the scalar one\n");
+	return 0;
+}
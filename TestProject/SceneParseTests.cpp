@@ -0,0 +1,226 @@
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+#include "CommonCode.h"
+
+//Layer element of a generated scene
+struct LayerSpec
+{
+	std::string name; //JSON string content, may hold escapes
+	std::string opaque; //JSON value of "opaque", empty --> key left out
+	int positionCount;
+	bool isPositionsFirst;
+	bool hasDuplicatePositions;
+	bool hasEscapedPositionsKey;
+	bool hasExtraKey;
+	double malformedChance;
+};
+
+std::string MakePosition(std::mt19937& random, const double malformedChance)
+{
+	//Elements that aren't 3 ints, they are counted as failed blocks
+	static const char* const malformedElements[]{
+		"[1, 2]", "[1, 2, 3, 4]", "[\"a\", 1, 2]", "[1.5, 2, 3]", "{}", "7", "null", "[[1], 2, 3]", "[]", "[4294967296, 0, 0]"
+	};
+
+	std::uniform_real_distribution<double> chanceDistribution{ 0.0, 1.0 };
+	if (chanceDistribution(random) < malformedChance)
+	{
+		std::uniform_int_distribution<size_t> malformedDistribution{ 0, sizeof(malformedElements) / sizeof(malformedElements[0]) - 1 };
+		return malformedElements[malformedDistribution(random)];
+	}
+
+	std::uniform_int_distribution<int> coordDistribution{ -3000, 3000 };
+	return "[" + std::to_string(coordDistribution(random)) + ", " + std::to_string(coordDistribution(random)) + ",\n" + std::to_string(coordDistribution(random)) + "]";
+}
+
+std::string MakeLayer(std::mt19937& random, const LayerSpec& spec)
+{
+	std::string positions{ "[" };
+	for (int i{ 0 }; i < spec.positionCount; ++i)
+	{
+		if (i > 0) positions += (i % 7 == 0) ? ",\n\t" : ", ";
+		positions += MakePosition(random, spec.malformedChance);
+	}
+	positions += "]";
+
+	const std::string positionsKey{ spec.hasEscapedPositionsKey ? "\"posi\\u0074ions\"" : "\"positions\"" };
+	std::vector<std::string> members{};
+	if (spec.isPositionsFirst) members.push_back(positionsKey + ": " + positions);
+	if (spec.hasExtraKey) members.push_back("\"extra\": {\"positions\": [[1, 2, 3]], \"layer\": \"pos]itions\", \"list\": [\"[\", \"{\"]}");
+	members.push_back("\"layer\": \"" + spec.name + "\"");
+	if (spec.opaque.empty() == false) members.push_back("\"opaque\": " + spec.opaque);
+	if (spec.isPositionsFirst == false) members.push_back(positionsKey + ":\n" + positions);
+	if (spec.hasDuplicatePositions) members.push_back("\"positions\": [[5, 6, 7], [8, 9]]");
+
+	std::string layer{ "{" };
+	for (size_t i{ 0 }; i < members.size(); ++i)
+	{
+		if (i > 0) layer += ", ";
+		layer += members[i];
+	}
+	return layer + "}";
+}
+
+//Every part of the scene has to come out of both parses the same, returns the number of differences
+int CompareScenes(const wchar_t* caseName, const bool isSceneA, const commonCode::BlockList& blocksA, const commonCode::MaterialRegistry& materialsA, const commonCode::SceneWarnings& warningsA,
+	const bool isSceneB, const commonCode::BlockList& blocksB, const commonCode::MaterialRegistry& materialsB, const commonCode::SceneWarnings& warningsB)
+{
+	if (isSceneA != isSceneB)
+	{
+		wprintf_s(L"%s: scene is %s instead of %s\n", caseName, isSceneB ? L"valid" : L"invalid", isSceneA ? L"valid" : L"invalid");
+		return 1;
+	}
+
+	int failedCount{ 0 };
+	if (warningsA.failedLayerCount != warningsB.failedLayerCount || warningsA.failedBlockCount != warningsB.failedBlockCount)
+	{
+		wprintf_s(
+			L"%s: %d failed layers and %d failed blocks instead of %d and %d\n", caseName,
+			static_cast<int>(warningsB.failedLayerCount), static_cast<int>(warningsB.failedBlockCount), static_cast<int>(warningsA.failedLayerCount), static_cast<int>(warningsA.failedBlockCount)
+		);
+		++failedCount;
+	}
+
+	if (materialsA.GetNames() != materialsB.GetNames())
+	{
+		wprintf_s(L"%s: %d materials instead of %d, or in another order\n", caseName, static_cast<int>(materialsB.GetCount()), static_cast<int>(materialsA.GetCount()));
+		++failedCount;
+	}
+
+	if (blocksA.GetCount() != blocksB.GetCount())
+	{
+		wprintf_s(L"%s: %d blocks instead of %d\n", caseName, static_cast<int>(blocksB.GetCount()), static_cast<int>(blocksA.GetCount()));
+		return failedCount + 1;
+	}
+
+	for (size_t i{ 0 }; i < blocksA.GetCount(); ++i)
+	{
+		if (blocksA.GetX(i) != blocksB.GetX(i) || blocksA.GetY(i) != blocksB.GetY(i) || blocksA.GetZ(i) != blocksB.GetZ(i)
+			|| blocksA.GetMaterialId(i) != blocksB.GetMaterialId(i) || blocksA.IsOpaque(i) != blocksB.IsOpaque(i))
+		{
+			wprintf_s(
+				L"%s: block %d is %d, %d, %d of material %d instead of %d, %d, %d of material %d\n", caseName, static_cast<int>(i),
+				blocksB.GetX(i), blocksB.GetY(i), blocksB.GetZ(i), static_cast<int>(blocksB.GetMaterialId(i)),
+				blocksA.GetX(i), blocksA.GetY(i), blocksA.GetZ(i), static_cast<int>(blocksA.GetMaterialId(i))
+			);
+			return failedCount + 1;
+		}
+	}
+	return failedCount;
+}
+
+//Parses generated scenes with ParseScene and with ParseSceneParallel on 2 and 8 threads and every supported level,
+//the parallel parse has to give the same blocks in file order, materials and warnings
+//Layers above PARSE_RANGE_SIZE are split, the scan is checked to do so, otherwise a fallback to ParseScene would hide its errors
+int main()
+{
+	constexpr int sceneCount{ 6 };
+	constexpr int splitPositionCount{ 30000 }; //about 400 kB of positions
+
+	const commonCode::SimdLevel simdLevels[]{ commonCode::SimdLevel::SCALAR, commonCode::SimdLevel::SSE2, commonCode::SimdLevel::SSE42, commonCode::SimdLevel::AVX2 };
+	const char* const names[]{ "stone", "dirt", "gla\\\"ss", "wa]ter[", "sa{nd},", "positions", "lea\\\\ves" }; //escaped quotes and brackets
+
+	std::mt19937 random{ 20240615 };
+	std::uniform_int_distribution<size_t> nameDistribution{ 0, sizeof(names) / sizeof(names[0]) - 1 };
+	std::uniform_int_distribution<int> smallCountDistribution{ 0, 40 };
+
+	commonCode::WorkerPool twoThreadPool{ 2 };
+	commonCode::WorkerPool eightThreadPool{ 8 };
+	commonCode::WorkerPool* const pWorkerPools[]{ &twoThreadPool, &eightThreadPool };
+	int failedCount{ 0 };
+
+	for (int sceneIdx{ 0 }; sceneIdx < sceneCount; ++sceneIdx)
+	{
+		auto randomName = [&]() { return std::string{ names[nameDistribution(random)] }; };
+		const double malformedChance{ (sceneIdx % 2 == 0) ? 0.02 : 0.0 };
+
+		std::vector<LayerSpec> specs{
+			LayerSpec{ randomName(), "true", splitPositionCount, false, false, false, false, malformedChance }, //split
+			LayerSpec{ randomName(), "false", splitPositionCount, true, false, false, true, malformedChance }, //split, positions before layer and opaque
+			LayerSpec{ randomName(), (sceneIdx % 2 == 0) ? "" : "\"yes\"", splitPositionCount, false, false, false, false, 0.01 }, //split but invalid
+			LayerSpec{ randomName(), "true", splitPositionCount, false, true, false, false, malformedChance }, //duplicate positions, parsed whole
+		};
+		for (int i{ 0 }; i < 8; ++i)
+		{
+			specs.push_back(LayerSpec{ randomName(), (i % 2 == 0) ? "true" : "false", smallCountDistribution(random), i % 3 == 0, i == 2, i == 5, i % 4 == 1, 0.1 });
+		}
+		std::shuffle(specs.begin(), specs.end(), random);
+
+		std::string scene{ "[\n" };
+		for (size_t i{ 0 }; i < specs.size(); ++i)
+		{
+			if (i > 0) scene += ",\n";
+			scene += MakeLayer(random, specs[i]);
+			if (i == 3) scene += ", 5, \"not a layer\""; //elements that aren't layers
+		}
+		scene += "\n]\n";
+
+		//Reference
+		commonCode::BlockList expectedBlocks{};
+		commonCode::MaterialRegistry expectedMaterials{};
+		commonCode::SceneWarnings expectedWarnings{};
+		commonCode::ScanMemoryStream ms{ scene.data(), scene.size(), commonCode::SimdLevel::SCALAR };
+		const bool isExpectedScene{ commonCode::ParseScene(ms, expectedBlocks, expectedMaterials, expectedWarnings) };
+		if (isExpectedScene == false)
+		{
+			wprintf_s(L"Scene %d: generated scene doesn't parse!\n", sceneIdx);
+			++failedCount;
+			continue;
+		}
+
+		for (const commonCode::SimdLevel simdLevel : simdLevels)
+		{
+			if (simdLevel > commonCode::GetSimdLevel()) continue;
+
+			//The 3 large layers with a single positions array have to be split
+			std::vector<commonCode::LayerLayout> layers{};
+			commonCode::ScanSceneLayout(scene.data(), scene.data() + scene.size(), commonCode::PARSE_RANGE_SIZE, layers, simdLevel);
+			const size_t splitLayerCount{ static_cast<size_t>(std::count_if(layers.begin(), layers.end(),
+				[](const commonCode::LayerLayout& layer) { return layer.positionRanges.size() > 1; })) };
+			if (splitLayerCount != 3)
+			{
+				wprintf_s(L"Scene %d, %s: %d layers are split instead of 3\n", sceneIdx, commonCode::ToString(simdLevel), static_cast<int>(splitLayerCount));
+				++failedCount;
+			}
+
+			for (commonCode::WorkerPool* const pWorkerPool : pWorkerPools)
+			{
+				commonCode::BlockList blocks{};
+				commonCode::MaterialRegistry materials{};
+				commonCode::SceneWarnings warnings{};
+				const bool isScene{ commonCode::ParseSceneParallel(scene.data(), scene.size(), blocks, materials, warnings, *pWorkerPool, simdLevel) };
+
+				const std::wstring caseName{ L"Scene " + std::to_wstring(sceneIdx) + L", " + commonCode::ToString(simdLevel) + L" on " + std::to_wstring(pWorkerPool->GetThreadCount()) + L" threads" };
+				failedCount += CompareScenes(caseName.c_str(), isExpectedScene, expectedBlocks, expectedMaterials, expectedWarnings, isScene, blocks, materials, warnings);
+			}
+		}
+
+		//Broken syntax is reported the same way
+		const std::string brokenScene{ scene.substr(0, scene.size() / 2) };
+		commonCode::BlockList brokenBlocks{};
+		commonCode::MaterialRegistry brokenMaterials{};
+		commonCode::SceneWarnings brokenWarnings{};
+		commonCode::ScanMemoryStream brokenMs{ brokenScene.data(), brokenScene.size(), commonCode::SimdLevel::SCALAR };
+		const bool isBrokenScene{ commonCode::ParseScene(brokenMs, brokenBlocks, brokenMaterials, brokenWarnings) };
+
+		commonCode::BlockList blocks{};
+		commonCode::MaterialRegistry materials{};
+		commonCode::SceneWarnings warnings{};
+		const bool isScene{ commonCode::ParseSceneParallel(brokenScene.data(), brokenScene.size(), blocks, materials, warnings, eightThreadPool, commonCode::GetSimdLevel()) };
+		const std::wstring caseName{ L"Broken scene " + std::to_wstring(sceneIdx) };
+		failedCount += CompareScenes(caseName.c_str(), isBrokenScene, brokenBlocks, brokenMaterials, brokenWarnings, isScene, blocks, materials, warnings);
+	}
+
+	if (failedCount > 0)
+	{
+		wprintf_s(L"%d differences between the parallel and the serial parse!\n", failedCount);
+		return -1;
+	}
+
+	wprintf_s(L"The parallel parse matches ParseScene\n");
+	return 0;
+}
@@ -0,0 +1,70 @@
+#include <cstdio>
+#include <vector>
+
+#include "CubeMesh.h"
+
+//Welds the corners of cubes that lie far apart, their corners must never share a vertex
+//Two neighbouring cubes at the end check that shared corners are still welded
+int main()
+{
+	const int origins[][3]{
+		{ 0, 0, 0 },
+		{ 0, 1 << 21, 0 }, //aliased with the origin when keys kept 21 bits per axis
+		{ 1 << 20, 0, 0 },
+		{ -(1 << 20), 0, 0 },
+		{ 0, 0, 1 << 24 },
+		{ 0, 0, -(1 << 24) },
+		{ 1 << 30, -(1 << 30), 1 << 30 },
+	};
+	constexpr int originCount{ static_cast<int>(sizeof(origins) / sizeof(origins[0])) };
+
+	commonCode::VertexWelder welder{};
+	std::vector<int> vertexIndices{};
+	int failedCount{ 0 };
+
+	for (const int* origin : origins)
+	{
+		for (int vertexIdx{ 0 }; vertexIdx < 8; ++vertexIdx)
+		{
+			vertexIndices.push_back(welder.GetVertexIdx(origin[0] + ((vertexIdx >> 2) & 1), origin[1] + ((vertexIdx >> 1) & 1), origin[2] + (vertexIdx & 1)));
+		}
+	}
+
+	if (welder.GetVertexCount() != static_cast<size_t>(originCount * 8))
+	{
+		wprintf_s(L"%d corners of far apart cubes were welded into %d vertices!\n", originCount * 8, static_cast<int>(welder.GetVertexCount()));
+		++failedCount;
+	}
+
+	//Asking again gives the same vertices
+	for (int cubeIdx{ 0 }; cubeIdx < originCount; ++cubeIdx)
+	{
+		const int* origin{ origins[cubeIdx] };
+		for (int vertexIdx{ 0 }; vertexIdx < 8; ++vertexIdx)
+		{
+			const int weldedIdx{ welder.GetVertexIdx(origin[0] + ((vertexIdx >> 2) & 1), origin[1] + ((vertexIdx >> 1) & 1), origin[2] + (vertexIdx & 1)) };
+			if (weldedIdx != vertexIndices[cubeIdx * 8 + vertexIdx])
+			{
+				wprintf_s(L"Corner %d of cube %d moved from vertex %d to %d!\n", vertexIdx, cubeIdx, vertexIndices[cubeIdx * 8 + vertexIdx], weldedIdx);
+				++failedCount;
+			}
+		}
+	}
+
+	//A cube next to the last one shares 4 of its corners
+	const int* lastOrigin{ origins[originCount - 1] };
+	for (int vertexIdx{ 0 }; vertexIdx < 8; ++vertexIdx)
+	{
+		welder.GetVertexIdx(lastOrigin[0] + 1 + ((vertexIdx >> 2) & 1), lastOrigin[1] + ((vertexIdx >> 1) & 1), lastOrigin[2] + (vertexIdx & 1));
+	}
+	if (welder.GetVertexCount() != static_cast<size_t>(originCount * 8 + 4))
+	{
+		wprintf_s(L"Neighbouring cubes have %d vertices instead of 12!\n", static_cast<int>(welder.GetVertexCount()) - (originCount - 1) * 8);
+		++failedCount;
+	}
+
+	if (failedCount > 0) return -1;
+
+	wprintf_s(L"Far apart corners are kept apart and shared corners are welded\n");
+	return 0;
+}